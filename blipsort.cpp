@@ -0,0 +1,146 @@
+#define BLIPSORT_BUILD
+#include "blipsort.h"
+#include "sort.h"
+
+/**
+ * Clones each entry point per ISA level, and lets
+ * the loader pick one through an ifunc. Flatten
+ * inlines the whole sort into each clone; this is
+ * why the entry points use the explicit stack of
+ * Resumable, since a recursive qSort would be
+ * shared by all clones at the baseline ISA.
+ */
+#if defined(__GNUC__) && defined(__x86_64__) && \
+    defined(__linux__)
+#define BLIPSORT_CLONES __attribute__(( \
+    target_clones("default", "arch=x86-64-v2", \
+        "arch=x86-64-v3", "arch=x86-64-v4"), flatten))
+#else
+#define BLIPSORT_CLONES
+#endif
+
+namespace
+{
+    /**
+     * Sorts the given array to completion on
+     * an explicit stack, turning a reversed
+     * array around first, as blipsort does.
+     *
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     */
+    template <typename E, class Cmp>
+    inline void run
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp
+        )
+    {
+        if(cnt < 2) return;
+        if(Algo::unreverse(a, a + (cnt - 1), cmp))
+            return;
+        Algo::Resumable<E, Cmp> r(a, cnt, cmp);
+        r.step(std::numeric_limits<uint64_t>::max());
+    }
+}
+
+extern "C"
+{
+    BLIPSORT_CLONES
+    void blipsort_i32
+        (
+        int32_t* const a,
+        const uint32_t cnt
+        )
+    {
+        run(a, cnt, std::less<>());
+    }
+
+    BLIPSORT_CLONES
+    void blipsort_u64
+        (
+        uint64_t* const a,
+        const uint32_t cnt
+        )
+    {
+        run(a, cnt, std::less<>());
+    }
+
+    BLIPSORT_CLONES
+    void blipsort_f64
+        (
+        double* const a,
+        const uint32_t cnt
+        )
+    {
+        // As blipsortFloat, with
+        // NaNs last.
+        constexpr uint64_t
+            Sign = uint64_t(1) << 63U,
+            Inf = std::bit_cast<uint64_t>
+                (std::numeric_limits<double>::infinity());
+        double * high = a + cnt;
+        for(double* i = a; i < high;)
+        {
+            const double f = *i;
+            if((std::bit_cast<uint64_t>(f) & ~Sign) > Inf)
+            {
+                *i = *--high;
+                *high = f;
+                continue;
+            }
+            *i++ = Algo::floatKey(f);
+        }
+        run(a, uint32_t(high - a), 
+            Algo::FloatLess<double>());
+        for(double* i = a; i < high; ++i)
+            *i = Algo::floatValue(*i);
+    }
+
+    BLIPSORT_CLONES
+    void blipsort_kv_u64_u64
+        (
+        blipsort_kv_u64_u64_t* const a,
+        const uint32_t cnt
+        )
+    {
+        run(a, cnt, []
+            (
+            const blipsort_kv_u64_u64_t & x,
+            const blipsort_kv_u64_u64_t & y
+            )
+        {
+            return x.key < y.key;
+        });
+    }
+
+    BLIPSORT_CLONES
+    void blipsort_u128
+        (
+        blipsort_u128_t* const a,
+        const uint32_t cnt
+        )
+    {
+        // Compare both words without
+        // branching: one cmp and one
+        // sbb with __int128.
+        run(a, cnt, []
+            (
+            const blipsort_u128_t & x,
+            const blipsort_u128_t & y
+            )
+        {
+#if defined(__SIZEOF_INT128__)
+            return (Algo::WideKey(x.hi) << 64U | x.lo) <
+                (Algo::WideKey(y.hi) << 64U | y.lo);
+#else
+            return (x.hi < y.hi) | 
+                ((x.hi == y.hi) & (x.lo < y.lo));
+#endif
+        });
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef BLIPSORT_H
+#define BLIPSORT_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(BLIPSORT_BUILD)
+#    define BLIPSORT_API __declspec(dllexport)
+#  else
+#    define BLIPSORT_API __declspec(dllimport)
+#  endif
+#else
+#  define BLIPSORT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A key-value pair, sorted by key.
+ */
+typedef struct blipsort_kv_u64_u64_t
+{
+    uint64_t key;
+    uint64_t value;
+} blipsort_kv_u64_u64_t;
+
+/**
+ * A 128-bit unsigned key, such as a UUID or an
+ * IPv6 address, sorted by hi and then by lo.
+ */
+typedef struct blipsort_u128_t
+{
+    uint64_t lo;
+    uint64_t hi;
+} blipsort_u128_t;
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>blipsort C ABI</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Precompiled entry points for common element
+ * types, built from blipsort.cpp. Each sorts in
+ * ascending order, in place. On x86-64 Linux each
+ * is cloned per ISA level and the fastest clone
+ * is chosen once, at load time.
+ * </p>
+ *
+ * <p>
+ * Doubles sort with NaNs last. Pairs sort by key
+ * only, and pairs with equal keys may be
+ * reordered. 128-bit keys compare as two words,
+ * high word first.
+ * </p>
+ *
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ */
+BLIPSORT_API void blipsort_i32(int32_t* a, uint32_t cnt);
+BLIPSORT_API void blipsort_u64(uint64_t* a, uint32_t cnt);
+BLIPSORT_API void blipsort_f64(double* a, uint32_t cnt);
+BLIPSORT_API void blipsort_kv_u64_u64
+    (
+    blipsort_kv_u64_u64_t* a,
+    uint32_t cnt
+    );
+BLIPSORT_API void blipsort_u128
+    (
+    blipsort_u128_t* a,
+    uint32_t cnt
+    );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //BLIPSORT_H
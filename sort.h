@@ -1,10 +1,43 @@
 #pragma once
 #ifndef SORT_H
 #define SORT_H
+#if __cplusplus < 202002L && \
+    (!defined(_MSVC_LANG) || _MSVC_LANG < 202002L)
+#error "sort.h requires C++20 (-std=c++20 or /std:c++20)"
+#endif
 #include <iostream>
+#include <array>
 #include <cassert>
 #include <bit>
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <atomic>
+#include <future>
+#include <limits>
+#include <type_traits>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <new>
+#include <thread>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cmath>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#if defined(BLIPSORT_PROFILE)
+#include <cstdio>
+#include <mutex>
+#include <linux/perf_event.h>
+#endif
+#endif
 
 namespace Algo
 { enum : uint32_t
@@ -13,78 +46,129 @@ namespace Algo
     AscendingThreshold = 8,
     LargeDataThreshold = 128,
     BlockSize          = 64, 
-#if __cpp_lib_bitops >= 201907L
-    DoubleWordBitCount = 31,
-#else
-    DeBruijnShiftAmoun = 58
-#endif
+    StackDepth         = 256,
+    TaskThreshold      = 1U << 16U,
+    GallopThreshold    = 7,
+    SampleThreshold    = 1U << 20U,
+    Oversampling       = 16,
+    TreeLevels         = 7,
+    BucketBlockBytes   = 2048,
+    ReverseTolerance   = 8,
+    PrefetchBytes      = 1U << 11U,
+    CacheBytes         = 1U << 18U,
+    PointeeWindow      = 16,
+    LomutoBytes        = 8,
+    TraceEvents        = 1U << 15U,
+    MergeThreshold     = 1U << 12U,
+    CompareRun         = 16,
+    NintherThreshold   = 1U << 13U,
+    RadixThreshold     = 1U << 8U,
+    FiberDepth         = 32,
+    MedianThreshold    = 1U << 10U,
+    Median27Threshold  = 1U << 20U,
+    DoubleWordBitCount = 31
 };
 
 /**
- * The DeBruijn constant.
+ * Sort mode flags. Modes are opt-in and
+ * compile away entirely when unset.
  */
-#if __cpp_lib_bitops < 201907L
-constexpr uint64_t DeBruijn64 =
-    0x03F79D71B4CB0A89L;
-#endif
+enum : uint32_t
+{
+    RandomMode = 1U << 0U,
+    StreamMode = 1U << 1U,
+    PointerMode = 1U << 2U,
+    BufferMode = 1U << 3U
+};
 
 /**
- * The DeBruijn map from key to integer
- * square index.
+ * Float sort policy flags. By default, NaNs 
+ * are placed last and -0.0 sorts before +0.0.
  */
-#if __cpp_lib_bitops < 201907L
-constexpr uint8_t DeBruijnTableF[] = 
+enum : uint32_t
 {
-    0,  47,  1, 56, 48, 27,  2, 60,
-    57, 49, 41, 37, 28, 16,  3, 61,
-    54, 58, 35, 52, 50, 42, 21, 44,
-    38, 32, 29, 23, 17, 11,  4, 62,
-    46, 55, 26, 59, 40, 36, 15, 53,
-    34, 51, 20, 43, 31, 22, 10, 45,
-    25, 39, 14, 33, 19, 30,  9, 24,
-    13, 18,  8, 12,  7,  6,  5, 63
+    NaNsLast   = 0,
+    NaNsFirst  = 1U << 0U,
+    TotalOrder = 1U << 1U,
+    MergeZeros = 1U << 2U
 };
-#endif
 
 /**
- * Fill trailing bits using prefix fill.
+ * <h1>
+ *  <b>
+ *  <i>Expensive</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Whether elements of type E are expensive to
+ * move, so that Hoare partitioning, with fewer
+ * moves, should be used instead of branchless
+ * Lomuto. Lomuto copy-assigns on every step, but
+ * the default asks only for trivial copy 
+ * construction and destruction, and deliberately 
+ * ignores assignment: std::pair and std::tuple 
+ * have user-provided assignment, yet still move 
+ * in one register. Of those types, the ones of a
+ * power-of-two size up to LomutoBytes are cheap.
+ * Larger or odd-sized types need several loads 
+ * and stores per move, and Lomuto moves every 
+ * element. Specialize this trait to override the 
+ * choice for a type, as for one whose assignment 
+ * does real work.
+ * </p>
  *
- * @code
- * Example:
- *       10000000 >> 1
- *     = 01000000 | 10000000
- *     = 11000000 >> 2
- *     = 00110000 | 11000000
- *     = 11110000 >> 4
- *     = 00001111 | 11110000
- *     = 11111111
- * @endcode
- * @tparam E The type
- * @param x The integer
+ * <p>
+ * Measured on 2M random elements, as the time
+ * with Lomuto over the time with Block Hoare:
+ * 1.03 to 1.09 for 4 and 8-byte scalars, 0.94 for
+ * double, 1.04 for std::pair of two uint32_t and
+ * 0.91 to 1.08 for 4 and 8-byte records, against
+ * 1.10 for a 16-byte record and 2.6 for unsigned
+ * __int128. LomutoBytes is set at that crossover:
+ * 16-byte types move through two registers and the
+ * halves do not forward to the next 16-byte load.
+ * Larger records are two or three times slower.
+ * </p>
+ *
+ * <p>
+ * A comparator that branches also favors Hoare,
+ * whose mispredictions are not paid on every
+ * element. std::array of more than one element
+ * compares lexicographically; std::array of eight
+ * bytes measured 1.25, so it is expensive.
+ * </p>
+ *
+ * @tparam E the element type
  */
-#if __cpp_lib_bitops < 201907L
-constexpr void parallelPrefixFill
-    (
-    uint32_t & x
-    ) 
-{
-    x |= x >> 1U;
-    x |= x >> 2U;
-    x |= x >> 4U;
-    x |= x >> 8U;
-    x |= x >> 16U;
-}
-#endif
+template<typename E>
+struct Expensive : std::bool_constant
+<
+    !std::is_trivially_copy_constructible<E>::value ||
+    !std::is_trivially_destructible<E>::value ||
+    (sizeof(E) > LomutoBytes) ||
+    (sizeof(E) & (sizeof(E) - 1)) != 0
+> { };
+
+/**
+ * std::array compares lexicographically.
+ *
+ * @tparam T the element type
+ * @tparam N the number of elements
+ */
+template<typename T, size_t N>
+struct Expensive<std::array<T, N>> : std::bool_constant
+<
+    (N > 1) || Expensive<T>::value
+> { };
 
 /**
  * Calculates floor of log2
  * 
- * @authors Kim Walisch - source
- * @authors Mark Dickinson - source
  * @authors Ellie Moore 
- * @param bb bitboard to scan
- * @precondition bb != 0
- * @return index (0..63) of most significant one bit
+ * @param l the integer
+ * @precondition l != 0
+ * @return index (0..31) of most significant one bit
  */
 constexpr int log2
     (
@@ -92,14 +176,7 @@ constexpr int log2
     ) 
 {
     assert(l != 0);
-#if __cpp_lib_bitops >= 201907L
     return std::countl_zero(l) ^ DoubleWordBitCount; 
-#else
-    parallelPrefixFill(l);
-    return DeBruijnTableF[(int)
-        ((l * DeBruijn64) >> DeBruijnShiftAmoun)
-    ];
-#endif
 }
 
 /**
@@ -129,7 +206,7 @@ constexpr void swap
  * @param size the size of the current sub-array
  */
 template<typename E, class Cmp>
-inline void siftDown
+constexpr void siftDown
     (
     E* const a,
     const int i,
@@ -217,7 +294,7 @@ inline void siftDown
  * @param high a pointer to the rightmost index
  */
 template<typename E, class Cmp>
-inline void hSort
+constexpr void hSort
     (
     E* const low,
     E* const high,
@@ -278,7 +355,7 @@ inline void hSort
  */
 template
 <bool NoGuard, bool Guard, bool Bail = true, typename E, class Cmp>
-inline bool iSort
+constexpr bool iSort
     (
     E *const low, 
     E *const high,
@@ -290,18 +367,12 @@ inline bool iSort
     E* r = high;
     int moves = 0;
 
-    // We aren't guarding, jump
-    // straight into pair insertion
-    // sort.
-    if constexpr (Guard)
-        goto g1;
-    if constexpr (NoGuard)
-        goto g2;
-
-    if (leftmost) 
+    // If we are guarding, use
+    // traditional insertion sort.
+    // If not, go straight into
+    // pair insertion sort.
+    if (Guard || (!NoGuard && leftmost)) 
     {
-        g1:
-
         // Traditional
         // insertion
         // sort.
@@ -324,8 +395,6 @@ inline bool iSort
     } 
     else 
     {
-        g2:
-
         // Pair insertion sort.
         // Skip elements that are
         // in ascending order.
@@ -433,6 +502,78 @@ constexpr void scramble
     }
 }
 
+/**
+ * SplitMix64 step. Advances the given state
+ * and returns a well-mixed 64-bit value.
+ *
+ * @authors Sebastiano Vigna - source
+ * @param s the generator state
+ */
+constexpr uint64_t splitMix
+    (
+    uint64_t & s
+    )
+{
+    uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31U);
+}
+
+/**
+ * Draws a pseudo-random offset in [0, n) 
+ * by multiply-shift (no division).
+ *
+ * @param s the generator state
+ * @param n the exclusive upper bound
+ * @precondition n < 2<sup>32</sup>
+ */
+constexpr size_t pick
+    (
+    uint64_t & s,
+    const size_t n
+    )
+{
+    return ((splitMix(s) >> 32U) * n) >> 32U;
+}
+
+/**
+ * Scramble a few elements at random
+ * offsets to help break patterns. 
+ * Unlike the deterministic scramble,
+ * the swapped positions depend on the
+ * seed and can not be predicted from
+ * the input.
+ *
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @param len the interval width
+ * @param s the generator state
+ */
+template<typename E>
+constexpr void scramble
+    (
+    E* const low, 
+    E* const high, 
+    const size_t len,
+    uint64_t & s
+    ) 
+{
+    if(len >= InsertionThreshold) 
+    {
+        swap(low,  low  + pick(s, len));
+        swap(high, high - pick(s, len));
+        if(len > LargeDataThreshold)
+        {
+            swap(low  + 1, low  + (1 + pick(s, len - 2)));
+            swap(low  + 2, low  + (2 + pick(s, len - 4)));
+            swap(high - 2, high - (2 + pick(s, len - 4)));
+            swap(high - 1, high - (1 + pick(s, len - 2)));
+        }
+    }
+}
+
 /**
  * Aligns the given pointer on 64-byte 
  * cachline.
@@ -454,832 +595,6176 @@ constexpr E* align
 /**
  * <h1>
  *  <b>
- *  <i>Blipsort</i>
+ *  <i>Scratch Arenas</i>
  *  </b>
  * </h1>
  *
- * <h2>Branchless Lomuto</h2>
- * <p>
- * The decades-old partitioning algorithm recently 
- * made a resurgence when researchers discovered 
- * ways to remove the inner branch. Lukas Bergdoll
- * and Orson Peters' method— published a little 
- * under two months ago— is the fastest yet. It 
- * employs a gap in the data to move elements 
- * twice per iteration rather than swapping them 
- * (three moves). For arithmetic and pointer types, 
- * Blipsort employs branchless Lomuto partitioning. 
- * For other, larger types, Blipsort uses branchless 
- * or branchful Hoare partitioning.
- * </p>
- * 
- * <h2>Pivot Selectivity</h2>
- * <p>
- * Blipsort carefully selects the pivot from the 
- * middle of five sorted candidates. These 
- * candidates allow the sort to determine whether 
- * the data in the current interval is approximately 
- * descending and inform its "partition left" strategy.
- * </p>
- * 
- * <h2>Insertion Sort</h2>
- * <p>
- * Blipsort uses Insertion sort on small intervals 
- * where asymptotic complexity matters less and 
- * instruction overhead matters more. Blipsort 
- * employs Java's Pair Insertion sort on every 
- * interval except the leftmost. Pair insertion 
- * sort inserts two elements at a time and doesn't 
- * need to perform a lower bound check, making it 
- * slightly faster than normal insertion sort in 
- * the context of quicksort.
- * </p>
- * 
- * <h2>Pivot Retention</h2>
- * <p>
- * Similar to PDQsort, if any of the three middlemost 
- * candidate pivots is equal to the rightmost element 
- * of the partition at left, Blipsort moves equal 
- * elements to the left with branchless Lomuto and 
- * continues to the right, solving the dutch-flag 
- * problem and yeilding linear time on data comprised 
- * of equal elements.
- * </p> 
- * 
- * <h2>Optimism</h2>
- * <p>
- * Similar to PDQsort, if the partition is "good" 
- * (not highly unbalanced), Blipsort switches to 
- * insertion sort. If the Insertion sort makes more 
- * than a constant number of moves, Blipsort bails 
- * and resumes quicksort. This allows Blipsort to 
- * achieve linear time on already-sorted data.
- * </p>
- * 
- * <h2>Breaking Patterns</h2>
- * <p>
- * Like PDQsort, if the partition is bad, Blipsort 
- * scrambles some elements to break up patterns.
- * </p>
- * 
- * <h2>Rotation</h2>
  * <p>
- * When all of the candidate pivots are strictly 
- * descending, it is very likely that the interval 
- * is descending as well. Lomuto partitioning slows 
- * significantly on descending data. Therefore, 
- * Blipsort neglects to sort descending candidates 
- * and instead swap-rotates the entire interval 
- * before partitioning.
+ * Modes that need scratch memory take it from an 
+ * arena policy, given as a template parameter and 
+ * default-constructed for each sort. Every arena 
+ * hands out BlockSize-aligned memory, returns null 
+ * rather than throwing, and expects its memory back 
+ * in the reverse order it was handed out.
  * </p>
  *
- * <h2>Custom Comparators</h2>
+ * <ul>
+ * <li>HeapArena takes each buffer from the heap.</li>
+ * <li>StackArena keeps up to Bytes in the sort's 
+ * own stack frame.</li>
+ * <li>ThreadArena keeps a region per thread that 
+ * grows to the largest need and is reused by every 
+ * later sort on that thread, so a hot thread stops 
+ * allocating.</li>
+ * <li>HugeArena is a ThreadArena mapped on 2MB 
+ * pages, to spare large scratch the TLB misses.</li>
+ * <li>BufferArena hands out memory the caller 
+ * provided to this thread.</li>
+ * </ul>
+ *
  * <p>
- * Blipsort allows its user to implement a custom 
- * boolean comparator. A comparator is best 
- * implemented with a lambda and no branches. A 
- * comparator implemented with a lambda can be 
- * inlined by an optimizing compiler, while a 
- * comparator implemented with a constexpr/inline 
- * function typically cannot.
+ * All but HeapArena fall back to the heap when 
+ * they run out.
  * </p>
+ */
+struct HeapArena
+{
+    void* allocate
+        (
+        const size_t bytes
+        )
+    {
+        return ::operator new(bytes, 
+            std::align_val_t(BlockSize), std::nothrow);
+    }
+
+    void deallocate
+        (
+        void* const p,
+        const size_t
+        )
+    {
+        ::operator delete(p, std::align_val_t(BlockSize));
+    }
+};
+
+/**
+ * A bump region over [base, base + cap) that 
+ * falls back to the heap when full. Empty 
+ * requests get the region's own address, 
+ * which is never given back to the heap.
+ */
+struct Region
+{
+    char * base = nullptr;
+    size_t cap = 0, top = 0;
+
+    static constexpr size_t round
+        (
+        const size_t bytes
+        )
+    {
+        return (bytes + (BlockSize - 1)) & 
+            ~size_t(BlockSize - 1);
+    }
+
+    void* allocate
+        (
+        const size_t bytes
+        )
+    {
+        const size_t b = round(bytes);
+        if(b == 0) return this;
+        if(cap - top < b)
+            return HeapArena().allocate(bytes);
+        void *const p = base + top;
+        top += b;
+        return p;
+    }
+
+    void deallocate
+        (
+        void* const p,
+        const size_t bytes
+        )
+    {
+        if(p == this) return;
+        char *const c = static_cast<char*>(p);
+        if(c < base || c >= base + cap)
+            return HeapArena().deallocate(p, bytes);
+        assert(c + round(bytes) == base + top);
+        top = c - base;
+    }
+};
+
+/**
+ * Keeps up to Bytes of scratch in the
+ * arena itself, on the sort's stack.
  *
- * @authors Josh Bloch - source
- * @authors Jon Bently - source
- * @authors Orson Peters - source
- * @authors Lukas Bergdoll - source
- * @authors Stefan Edelkamp - source
- * @authors Armin Weiß - source
- * @authors Ellie Moore
- * @tparam E the element type
- * @tparam Root whether this is the sort root
- * @param leftmost whether this is the leftmost part
- * @param low a pointer to the leftmost index
- * @param high a pointer to the rightmost index
- * @param height the distance of the current sort
- * tree from the initial height of 2log<sub>2</sub>n
+ * @tparam Bytes the capacity
  */
-template
-<bool Expense, bool Block, bool Root = true, typename E, class Cmp>
-inline void qSort
-    (
-    E * low,
-    E * high,
-    int height,
-    const Cmp cmp,
-    bool leftmost = true
-    ) 
+template<size_t Bytes = 1U << 12U>
+struct StackArena
 {
-    // Tail call loop.
-    for(size_t x = high - low;;) 
+    alignas(BlockSize) char buf[Bytes];
+    Region r { buf, Bytes, 0 };
+
+    StackArena() = default;
+    StackArena(const StackArena &) = delete;
+
+    void* allocate
+        (
+        const size_t bytes
+        )
     {
-        // If this is not the
-        // root node, sort the 
-        // interval by insertion
-        // sort if small enough.
-        if constexpr (!Root)
-        if (x < InsertionThreshold) 
-        {
-            // If we are in the Root,
-            // we won't be insertion 
-            // sorting until we 
-            // iterate on the rightmost
-            // part. However, we are
-            // not in the root here, so
-            // we need to be careful
-            // to use guarded insertion
-            // sort if this is the
-            // leftmost partition.
-            iSort<0,0,0>
-            (low, high, cmp, leftmost);
-            return;
-        }
+        return r.allocate(bytes);
+    }
 
-        // If this is not the root node, 
-        // heap sort when the runtime
-        // trends towards quadratic.
-        if constexpr (!Root)
-        if(height < 0)
-            return hSort(low, high, cmp);
+    void deallocate
+        (
+        void* const p,
+        const size_t bytes
+        )
+    {
+        r.deallocate(p, bytes);
+    }
+};
+
+/**
+ * Keeps a region per thread, reused by
+ * every sort on the thread. The region 
+ * grows, while empty, to the largest
+ * need seen so far.
+ *
+ * @tparam Huge whether to map the region
+ * on 2MB pages
+ */
+template<bool Huge = false>
+struct ThreadArena
+{
+    static constexpr size_t Page = 1U << 21U;
+
+    struct Home : Region
+    {
+        size_t want = 0;
 
-        // Find an inexpensive
-        // approximation of a third of
-        // the interval.
-        const size_t y = x >> 2U,
-            _3rd = y + (y >> 1U),
-            _6th = _3rd >> 1U;
-
-        // Find an approximate
-        // midpoint of the interval.
-        E *const mid = low + (x >> 1U);
-
-        // Assign tercile indices
-        // to candidate pivots.
-        E *const sl = low  + _3rd;
-        E *const sr = high - _3rd;
-
-        // Assign outer indices
-        // to candidate pivots.
-        E * cl = low  + _6th;
-        E * cr = high - _6th;
-
-        // If the candidates aren't
-        // descending...
-        // Insertion sort all five
-        // candidate pivots in-place.
-        if((!cmp(*cl, *low)) || 
-           (!cmp(*sl, *cl))  ||
-           (!cmp(*mid, *sl)) ||
-           (!cmp(*sr, *mid)) ||
-           (!cmp(*cr, *sr))  ||
-           (!cmp(*high, *cr)))
+        void release()
         {
-            
-            if(cmp(*low, *cl)) 
-                cl = low;
-            if(cmp(*cr, *high)) 
-                cr = high;
+            if(base == nullptr) return;
+#if defined(__linux__)
+            if constexpr (Huge)
+                munmap(base, cap);
+            else
+#endif
+            HeapArena().deallocate(base, cap);
+            base = nullptr; cap = 0;
+        }
 
-            if (cmp(*sl, *cl)) 
+        void grow()
+        {
+            release();
+            size_t c = want;
+#if defined(__linux__)
+            if constexpr (Huge)
             {
-                E e = *sl;
-                *sl = *cl;
-                *cl =   e;
+                c = (c + (Page - 1)) & ~(Page - 1);
+                void* m = mmap(nullptr, c, 
+                    PROT_READ | PROT_WRITE, 
+                    MAP_PRIVATE | MAP_ANONYMOUS | 
+                    MAP_HUGETLB, -1, 0);
+                // No reserved huge pages;
+                // ask for transparent ones.
+                if(m == MAP_FAILED)
+                {
+                    m = mmap(nullptr, c, 
+                        PROT_READ | PROT_WRITE, 
+                        MAP_PRIVATE | MAP_ANONYMOUS, 
+                        -1, 0);
+                    if(m != MAP_FAILED)
+                        madvise(m, c, MADV_HUGEPAGE);
+                }
+                base = m == MAP_FAILED ? 
+                    nullptr : static_cast<char*>(m);
             }
+            else
+#endif
+            base = static_cast<char*>
+                (HeapArena().allocate(c));
+            cap = base ? c : 0;
+        }
 
-            if (cmp(*mid, *sl)) 
-            {
-                E e  = *mid;
-                *mid =  *sl;
-                *sl  =    e;
-                if (cmp(e, *cl)) 
-                {
-                    *sl = *cl;
-                    *cl =   e;
-                }
-            }
+        ~Home() { release(); }
+    };
 
-            if (cmp(*sr, *mid))
-            {
-                E e  =  *sr;
-                *sr  = *mid;
-                *mid =    e;
-                if (cmp(e, *sl))
-                {
-                    *mid = *sl;
-                    *sl  =   e;
-                    if (cmp(e, *cl)) 
-                    {
-                        *sl = *cl;
-                        *cl =   e;
-                    }
-                }
-            }
+    static Home & home()
+    {
+        thread_local Home h;
+        return h;
+    }
 
-            if (cmp(*cr, *sr))
-            {
-                E e = *cr;
-                *cr = *sr;
-                *sr =   e;
-                if (cmp(e, *mid)) 
-                {
-                    *sr  = *mid;
-                    *mid =    e;
-                    if (cmp(e, *sl)) 
-                    {
-                        *mid = *sl;
-                        *sl  =   e;
-                        if (cmp(e, *cl)) 
-                        {
-                            *sl = *cl;
-                            *cl =   e;
-                        }
-                    }
-                }
-            }
-        }
+    void* allocate
+        (
+        const size_t bytes
+        )
+    {
+        Home & h = home();
+        const size_t need = h.top + Region::round(bytes);
+        if(need > h.want) 
+            h.want = need > (h.want << 1U) ? 
+                need : h.want << 1U;
+        if(h.top == 0 && h.cap < h.want) 
+            h.grow();
+        return h.allocate(bytes);
+    }
 
-        // If the candidates are
-        // descending, then the
-        // interval is likely to
-        // be descending somewhat.
-        // rotate the entire interval
-        // around the midpoint.
-        // Don't worry about the
-        // even size case. One
-        // out-of-order element
-        // is no big deal.
-        else
-        {
-            E* u = low;
-            E* q = high;
-            while(u < mid)
-            {
-                E e = *u;
-                *u++ = *q;
-                *q-- = e;
-            }
-        }
-        
-        // If any middle candidate 
-        // pivot is equal to the 
-        // rightmost element of the 
-        // partition to the left,
-        // swap pivot duplicates to 
-        // the side and sort the 
-        // remainder. This is an
-        // alternative to dutch-flag
-        // partitioning.
-        if(!leftmost)
-        {
-            // Check the pivot to 
-            // the left.
-            E h = *(low - 1);
-            if(!cmp(h, *sl)  || 
-               !cmp(h, *mid) || 
-               !cmp(h, *sr))
-            {
-                E* l = low - 1,
-                 * g = high + 1;
-
-                // skip over data
-                // in place.         
-                while(cmp(h, *--g));
-
-                if(g == high)
-                    while(!cmp(h, *++l) && l < g);
-                else 
-                    while(!cmp(h, *++l));
-
-                // If we are sorting 
-                // non-arithmetic types,
-                // use Hoare for fewer
-                // moves.
-                if constexpr (Expense)
-                {
-        /**
-         * Partition left by branchful Hoare scheme
-         * 
-         * During partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |    ... == h     |        ... ? ...        |     ... > h     |
-         * +-------------------------------------------------------------+
-         * ^                 ^                         ^                 ^
-         * low               l                         k              high
-         * 
-         * After partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |           ... == h           |            > h ...           |
-         * +-------------------------------------------------------------+
-         * ^                              ^                              ^
-         * low                            l                           high
-         */
-                    while(l < g)
-                    {
-                        swap(l, g);
-                        while(cmp(h, *--g));
-                        while(!cmp(h, *++l));
-                    }
-                }
+    void deallocate
+        (
+        void* const p,
+        const size_t bytes
+        )
+    {
+        home().deallocate(p, bytes);
+    }
+};
 
-                // If we are sorting 
-                // arithmetic types,
-                // use branchless lomuto
-                // for fewer branches.
-                else
-                {   
-        /**
-         * Partition left by branchless Lomuto scheme
-         * 
-         * During partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |  ... == h  |  ... > h  | * |     ... ? ...      |  ... > h  |
-         * +-------------------------------------------------------------+
-         * ^            ^           ^                        ^           ^
-         * low          l           k                        g         high
-         * 
-         * After partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |           ... == h           |            > h ...           |
-         * +-------------------------------------------------------------+
-         * ^                              ^                              ^
-         * low                            l                           high
-         */
-                    E * k = l, p = *l;
-                    while(k < g)
-                    {
-                        *k = *l;
-                        *l = *++k;
-                        l += !cmp(h, *l);
-                    }
-                    *k = *l; *l = p;
-                }
+using HugeArena = ThreadArena<true>;
 
-                // Advance low to the
-                // start of the right
-                // partition.
-                low = l;
+/**
+ * Hands out memory the caller provided to
+ * the calling thread. The memory must stay
+ * valid until the next provide.
+ */
+struct BufferArena
+{
+    static Region & home()
+    {
+        thread_local Region r;
+        return r;
+    }
 
-                // If we have nothing 
-                // left to sort, return.
-                if(low >= high)
-                    return;
+    /**
+     * Provides scratch memory to later sorts 
+     * on this thread.
+     *
+     * @param p the memory
+     * @param bytes the size of the memory
+     */
+    static void provide
+        (
+        void* const p,
+        const size_t bytes
+        )
+    {
+        Region & r = home();
+        assert(r.top == 0);
+        char *const c = align(static_cast<char*>(p));
+        const size_t skip = c - static_cast<char*>(p);
+        r.base = c; r.top = 0;
+        r.cap = bytes > skip ? (bytes - skip) & 
+            ~size_t(BlockSize - 1) : 0;
+    }
 
-                // Calculate the interval 
-                // width and loop.
-                x = high - low;
-                continue;
-            }
-        }
+    void* allocate
+        (
+        const size_t bytes
+        )
+    {
+        return home().allocate(bytes);
+    }
+
+    void deallocate
+        (
+        void* const p,
+        const size_t bytes
+        )
+    {
+        home().deallocate(p, bytes);
+    }
+};
+
+/**
+ * An array of n elements taken from an arena, 
+ * and given back when it goes out of scope. 
+ * Null if the arena is out of memory.
+ *
+ * @tparam E the element type
+ * @tparam Arena the arena policy
+ */
+template<typename E, class Arena>
+class Scratch
+{
+    Arena & arena;
+    E * p;
+    size_t n;
+
+public:
 
-        // Initialize l and k.
-        E *l = ternary<Expense>(low, low - 1),
-          *k = high + 1, * g;
-
-        // Assign midpoint to pivot
-        // variable.
-        const E p = *mid;
-
-        // If we are sorting 
-        // non-arithmetic types, bring 
-        // left end inside. Left end 
-        // will be replaced and pivot 
-        // will be swapped back later.
-        if constexpr(Expense)
-            *mid = *low;
-
-        // skip over data
-        // in place.
-        while(cmp(*++l, p));
-
-        // If we are sorting 
-        // arithmetic types, bring 
-        // left end inside. Left end 
-        // will be replaced and pivot 
-        // will be swapped back later.
-        if constexpr(!Expense)
-            *mid = *l;
-
-        // skip over data
-        // in place.
-        if(ternary<Expense>
-            (l == low + 1, l == low))
-            while(!cmp(*--k, p) && k > l);
+    /**
+     * @param arena the arena
+     * @param n the number of elements
+     * @param zero whether to value-initialize
+     */
+    Scratch
+        (
+        Arena & arena,
+        const size_t n,
+        const bool zero = false
+        ) : arena(arena), n(n)
+    {
+        p = static_cast<E*>
+            (arena.allocate(n * sizeof(E)));
+        if(p == nullptr) return;
+        if(zero) 
+            std::uninitialized_value_construct_n(p, n);
         else 
-            while(!cmp(*--k, p));
+            std::uninitialized_default_construct_n(p, n);
+    }
 
-        // Will we do a significant 
-        // amount of work during 
-        // partitioning?
-        bool work = 
-        ((l - low) + (high - k)) 
-            < (x >> 1U);
+    Scratch(const Scratch &) = delete;
 
-        // If we are sorting 
-        // non-arithmetic types and
-        // conserving memory, use 
-        // Hoare for fewer moves.
-        if constexpr (Expense && !Block)
-        {
-        /**
-         * Partition by branchful Hoare scheme
-         * 
-         * During partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |     ... < p     |        ... ? ...        |    ... >= p     |
-         * +-------------------------------------------------------------+
-         * ^                 ^                         ^                 ^
-         * low               l                         k              high
-         * 
-         * After partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |           ... < p            |            >= p ...          |
-         * +-------------------------------------------------------------+
-         * ^                              ^                              ^
-         * low                            l                           high
-         */
-            while(l < k)
-            {
-                swap(l, k);
-                while(cmp(*++l, p));
-                while(!cmp(*--k, p));
-            }
-            *low = *--l; *l = p;
-        }
+    ~Scratch()
+    {
+        if(p == nullptr) return;
+        std::destroy_n(p, n);
+        arena.deallocate(p, n * sizeof(E));
+    }
 
-        // If we are sorting 
-        // non-arithmetic types and
-        // not conserving memory, use 
-        // Block Hoare for fewer moves
-        // and fewer branches.
-        else if constexpr (Expense)
-        {
-        /**
-         * Partition by branchless (Block) Hoare scheme
-         * 
-         * During partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |  ... < p  |   cmp   |   ... ? ...   |   cmp   |  ... >= p   |
-         * +-------------------------------------------------------------+
-         * ^           ^         ^               ^         ^             ^
-         * low         _low      l               k     _high          high
-         * 
-         * After partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |           ... < p            |            >= p ...          |
-         * +-------------------------------------------------------------+
-         * ^                              ^                              ^
-         * low                            l                           high
-         */
-            if(l < k)
-            {
-                swap(l++, k);
-
-                // Set up blocks and
-                // align base pointers to
-                // the cacheline.
-                uint8_t 
-                ols[BlockSize << 1U], 
-                oks[BlockSize << 1U]; 
-                uint8_t
-                * olp = align(ols), 
-                * okp = align(oks); 
-                
-                // Initialize frame pointers.
-                E * _low = l, * _high = k;
+    E* get() const { return p; }
 
-                // Initialize offset counts and
-                // start indices for swap routine.
-                size_t nl = 0, nk = 0, ls = 0, ks = 0;
-                
-                while(l < k) 
-                {
-                    // If both blocks are empty, split 
-                    // the interval in two. Otherwise
-                    // give the whole interval to one
-                    // block.
-                    size_t xx = k - l,
-                    lspl = -(nl == 0) & (xx >> (nk == 0)),
-                    kspl = -(nk == 0) & (xx - lspl);
-                    
-                    // Fill the offset blocks. If the split 
-                    // for either block is larger than 64,
-                    // crop it and unroll the loop. Otherwise,
-                    // keep the loop fully rolled. This should
-                    // only happen near the end of partitioning.
-                    if(lspl >= BlockSize)
-                    {
-                        size_t i = -1;
-                        do
-                        {
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                            olp[nl] = ++i; nl += !cmp(*l++, p);
-                        } while(i < BlockSize - 1);
-                    }
-                    else
-                        for(size_t i = 0; i < lspl; ++i)
-                            olp[nl] = i, nl += !cmp(*l++, p);
+    E & operator[](const size_t i) const { return p[i]; }
 
-                    if(kspl >= BlockSize)
-                    {
-                        size_t i = 0;
-                        do
-                        {
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                            okp[nk] = ++i; nk += cmp(*--k, p);
-                        } while(i < BlockSize);
+    explicit operator bool() const { return p != nullptr; }
+};
 
-                    }
-                    else
-                        for(size_t i = 0; i < kspl;)
-                            okp[nk] = ++i, nk += cmp(*--k, p);
-
-                    // n = min(nl, nk), branchless.
-                    size_t n = 
-                        (nl & -(nl < nk)) + (nk & -(nl >= nk));
-
-                    // Swap the elements using the offsets. 
-                    // Set up working block pointers and lower 
-                    // block end pointer.
-                    uint8_t* 
-                    ll = olp + ls, * kk = okp + ks, * e = ll + n;
-
-                    // If the offset counts are equal, we are likely
-                    // to be ascending or descending. If ascending,
-                    // we don't need to do anything. If descending, 
-                    // use swaps to stay O(n). Both blocks must 
-                    // contain n offsets. If either block is empty,
-                    // fill it and come back.
-                    if(nl == nk)
-                        for(; ll < e; ++ll, ++kk)
-                            swap(_low + *ll, _high - *kk);
-
-                    // Otherwise, swap using a cyclic permutation.
-                    // Both blocks must contain n offsets. If either 
-                    // block is empty, fill it and come back.
-                    else if(n > 0)
-                    {
-                        E* _l = _low + *ll, * _k = _high - *kk;
-                        E t = *_l; *_l = *_k;
-                        for(++ll, ++kk; ll < e; ++ll, ++kk)
-                        {
-                            _l = _low  + *ll; *_k = *_l;
-                            _k = _high - *kk; *_l = *_k;
-                        } 
-                        *_k = t;
-                    }
+/**
+ * Prefetches the cachelines of n elements
+ * for writing, in stream mode only.
+ *
+ * @tparam Mode the sort mode flags
+ * @tparam E the element type
+ * @param p a pointer to the first element
+ * @param n the number of elements
+ */
+template<uint32_t Mode, typename E>
+constexpr void prefetch
+    (
+    const E* const p,
+    const size_t n
+    )
+{
+#if defined(__GNUC__)
+    if constexpr (Mode & StreamMode)
+    if(!std::is_constant_evaluated())
+    for(size_t b = 0; b < n * sizeof(E); b += BlockSize)
+        __builtin_prefetch(
+            reinterpret_cast<const char*>(p) + b, 1);
+#endif
+}
 
-                    // Adjust offset counts and starts. If a block
-                    // is empty, adjust its frame pointer.
-                    nl -= n; nk -= n;
-                    if(nl == 0) { ls = 0; _low  = l; } else ls += n; 
-                    if(nk == 0) { ks = 0; _high = k; } else ks += n;
-                }
+/**
+ * Prefetches the pointees of n pointer 
+ * elements, in pointer mode only.
+ *
+ * @tparam Mode the sort mode flags
+ * @tparam E the element type
+ * @param p a pointer to the first element
+ * @param n the number of elements
+ */
+template<uint32_t Mode, typename E>
+constexpr void fetch
+    (
+    const E* const p,
+    const size_t n
+    )
+{
+#if defined(__GNUC__)
+    if constexpr (Mode & PointerMode)
+    if(!std::is_constant_evaluated())
+    for(size_t i = 0; i < n; ++i)
+        __builtin_prefetch(std::to_address(p[i]));
+#endif
+}
 
-                // swap the remaining elements into place.
-                if(nl)
-                {
-                    olp += ls;
-                    for(uint8_t* ll = olp + nl;;)
-                    {
-                        swap(_low + *--ll, --l); 
-                        if(ll <= olp) break;
-                    }
-                }
+/**
+ * Sort phases, for profiling.
+ */
+enum : uint32_t
+{
+    ChoosePhase    = 0,
+    PartitionPhase = 1,
+    LeafPhase      = 2,
+    HeapPhase      = 3,
+    ScramblePhase  = 4,
+    PhaseCount     = 5
+};
 
-                if(nk)
-                {
-                    okp += ks;
-                    for(uint8_t* kk = okp + nk;;)
-                    {
-                        swap(_high - *--kk, l++);
-                        if(kk <= okp) break;
-                    }
-                }
-            }
-            
-            // Move the pivot into place.
-            *low = *--l; *l = p;
+#if defined(BLIPSORT_PROFILE) && defined(__linux__)
+/**
+ * <h1>
+ *  <b>
+ *  <i>Profile</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Hardware counters for each phase of qSort, by
+ * depth in the partition tree. Compiled in only
+ * when BLIPSORT_PROFILE is defined. Each thread 
+ * opens its own counters with perf_event_open on
+ * first use and charges them to its own table, 
+ * which is merged into the total when the thread 
+ * exits. Counters the kernel refuses (as under 
+ * most hypervisors, or with a strict 
+ * perf_event_paranoid) read zero; call counts, 
+ * elements and wall time are always kept.
+ * </p>
+ *
+ * <p>
+ * Each phase reads the counters twice, at the 
+ * cost of two system calls, so leaf phases are 
+ * inflated most. Compare phases against each 
+ * other rather than against an unprofiled build.
+ * </p>
+ */
+struct Profile
+{
+    static constexpr uint32_t
+        Counters = 5, Depths = 64;
+
+    static constexpr const char* Names[Counters] =
+    {
+        "cycles", "instructions", "branch-misses",
+        "L1d-misses", "LLC-misses"
+    };
+
+    struct Cell
+    {
+        uint64_t calls = 0, elements = 0, nanos = 0,
+                 value[Counters] = { };
+
+        void add
+            (
+            const Cell & c
+            )
+        {
+            calls += c.calls; elements += c.elements; 
+            nanos += c.nanos;
+            for(uint32_t i = 0; i < Counters; ++i)
+                value[i] += c.value[i];
         }
+    };
 
-        // If we are sorting 
-        // arithmetic types, use 
-        // branchless lomuto for 
-        // fewer branches.
-        else
+    struct Table
+    {
+        Cell cell[Depths][PhaseCount] = { };
+
+        void add
+            (
+            const Table & t
+            )
         {
-        /**
-         * Partition by branchless Lomuto scheme
-         * 
-         * During partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |  ... < p  |  ... >= p  | * |     ... ? ...     |  ... >= p  |
-         * +-------------------------------------------------------------+
-         * ^           ^            ^                       ^            ^
-         * low         l            g                       k         high
-         * 
-         * After partitioning:
-         * 
-         * +-------------------------------------------------------------+
-         * |           ... < p            |            >= p ...          |
-         * +-------------------------------------------------------------+
-         * ^                              ^                              ^
-         * low                            l                           high
-         */
-            g = l; 
-            
-            // If we are not conserving 
-            // memory, unroll the
-            // loop for a tiny boost.
-            if constexpr (Block)
+            for(uint32_t d = 0; d < Depths; ++d)
+            for(uint32_t p = 0; p < PhaseCount; ++p)
+                cell[d][p].add(t.cell[d][p]);
+        }
+    };
+
+    /**
+     * The counters and table of one thread.
+     */
+    struct Local : Table
+    {
+        int fd[Counters], slot[Counters], lead = -1;
+        uint32_t open = 0, depth = 0;
+
+        Local()
+        {
+            constexpr uint64_t L1 = 
+                PERF_COUNT_HW_CACHE_L1D |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8U) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U);
+            const uint32_t type[Counters] = 
             {
-                E* u = k - (BlockSize >> 2U);
-                while(g < u)
-                {
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                    *g = *l; *l = *++g; l += cmp(*l, p);
-                }
-            }
+                PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                PERF_TYPE_HARDWARE
+            };
+            const uint64_t config[Counters] = 
+            {
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_BRANCH_MISSES, L1,
+                PERF_COUNT_HW_CACHE_MISSES
+            };
 
-            while(g < k)
+            // The first counter that opens 
+            // leads the group, so that one
+            // read returns them all.
+            for(uint32_t i = 0; i < Counters; ++i)
             {
-                *g = *l;
-                *l = *++g;
-                l += cmp(*l, p);
+                perf_event_attr a = { };
+                a.size = sizeof(a);
+                a.type = type[i];
+                a.config = config[i];
+                a.exclude_kernel = 1;
+                a.exclude_hv = 1;
+                a.read_format = PERF_FORMAT_GROUP;
+                fd[i] = int(syscall(SYS_perf_event_open, 
+                    &a, 0, -1, lead, 0));
+                slot[i] = fd[i] < 0 ? -1 : int(open++);
+                if(lead < 0) lead = fd[i];
             }
-            *g = *l; *l = p;
+
+            std::lock_guard<std::mutex> g(lock());
+            live().push_back(this);
+            for(uint32_t i = 0; i < Counters; ++i)
+                if(slot[i] >= 0) opened() |= 1U << i;
         }
 
-        // Skip the pivot.
-        g = l + (l < high);
-        l -= (l > low);
+        ~Local()
+        {
+            for(uint32_t i = 0; i < Counters; ++i)
+                if(fd[i] >= 0) close(fd[i]);
 
-        // Cheaply calculate an
-        // eigth of the interval.
-        const size_t 
-            _8th = x >> 3U;
+            std::lock_guard<std::mutex> g(lock());
+            total().add(*this);
+            std::vector<Local*> & v = live();
+            for(size_t i = 0; i < v.size(); ++i)
+                if(v[i] == this)
+                { v[i] = v.back(); v.pop_back(); break; }
+        }
 
-        // Calculate interval widths.
-        const size_t
-            ls = l - low,
-            gs = high - g;
+        /**
+         * Reads the wall clock, then the counters.
+         */
+        void read
+            (
+            uint64_t* const v
+            ) const
+        {
+            v[Counters] = uint64_t(
+                std::chrono::steady_clock::now()
+                .time_since_epoch().count());
+            uint64_t b[Counters + 1] = { };
+            if(open && ::read(lead, b, 
+                sizeof(uint64_t) * (open + 1)) < 0)
+                b[0] = 0;
+            for(uint32_t i = 0; i < Counters; ++i)
+                v[i] = slot[i] < 0 || 
+                    uint64_t(slot[i]) >= b[0] ? 
+                    0 : b[slot[i] + 1];
+        }
 
-        // If the partition is fairly 
-        // balanced, try insertion sort.
-        // If insertion sort runtime
-        // trends higher than O(n), fall 
-        // back to quicksort.
-        if(ls >= _8th &&
-           gs >= _8th) 
+        void charge
+            (
+            const uint32_t phase,
+            const size_t x,
+            const uint64_t* const start
+            )
         {
-            if(work) goto l1;
-            if(!iSort<0,0>(low, l, cmp, leftmost)) 
-                goto l1;
-            if(!iSort<1,0>(g, high, cmp))
-                goto l2;
-            return;
+            uint64_t end[Counters + 1];
+            read(end);
+            Cell & c = cell[depth < Depths ? 
+                depth : Depths - 1][phase];
+            ++c.calls; c.elements += x + 1;
+            c.nanos += end[Counters] - start[Counters];
+            for(uint32_t i = 0; i < Counters; ++i)
+                c.value[i] += end[i] - start[i];
         }
+    };
 
-        // The partition is not balanced.
-        // scramble some elements and
-        // try to break the pattern.
-        scramble(low, l, ls);
-        scramble(g, high, gs);
+    static std::mutex & lock()
+    {
+        static std::mutex m;
+        return m;
+    }
 
-        // This was a bad partition,
-        // so decrement the height.
-        // When the height is zero,
-        // we will use heapsort.
-        --height;
+    static Table & total()
+    {
+        static Table t;
+        return t;
+    }
 
-        // Sort left portion.
-        l1: qSort<Expense,Block,0>
-        (low, l, height, cmp, leftmost);
+    static uint32_t & opened()
+    {
+        static uint32_t m = 0;
+        return m;
+    }
 
-        // Sort right portion 
-        // iteratively.
-        l2: low = g;
+    static std::vector<Local*> & live()
+    {
+        static std::vector<Local*> v;
+        return v;
+    }
+
+    static Local & local()
+    {
+        thread_local Local l;
+        return l;
+    }
+
+    /**
+     * Clears all counts. Call while no 
+     * sort is running.
+     */
+    static void reset()
+    {
+        std::lock_guard<std::mutex> g(lock());
+        total() = Table();
+        for(Local* l : live())
+            static_cast<Table&>(*l) = Table();
+    }
+
+    /**
+     * Reports the counts for each phase, then 
+     * for each phase at each depth. Call while 
+     * no sort is running.
+     *
+     * @return the report, as a text table
+     */
+    static std::string report()
+    {
+        constexpr const char* Phases[PhaseCount] =
+            { "choose", "partition", "leaf", 
+              "heap", "scramble" };
+        Table t; uint32_t on;
+        {
+            std::lock_guard<std::mutex> g(lock());
+            t.add(total());
+            for(Local* l : live())
+                t.add(*l);
+            on = opened();
+        }
+
+        char b[256];
+        std::string s;
+        const auto row = [&]
+            (
+            const char* const name,
+            const char* const depth,
+            const Cell & c
+            )
+        {
+            snprintf(b, sizeof(b), 
+                "%-10s %5s %10llu %12llu %10.3f", 
+                name, depth, 
+                (unsigned long long) c.calls,
+                (unsigned long long) c.elements, 
+                double(c.nanos) / 1e6);
+            s += b;
+            // Counters that never opened 
+            // are not available.
+            for(uint32_t i = 0; i < Counters; ++i)
+            {
+                if(on >> i & 1U)
+                    snprintf(b, sizeof(b), " %14llu",
+                        (unsigned long long) c.value[i]);
+                else
+                    snprintf(b, sizeof(b), " %14s", "n/a");
+                s += b;
+            }
+            s += '\n';
+        };
+
+        snprintf(b, sizeof(b), 
+            "%-10s %5s %10s %12s %10s", 
+            "phase", "depth", "calls", 
+            "elements", "ms");
+        s += b;
+        for(uint32_t i = 0; i < Counters; ++i)
+        {
+            snprintf(b, sizeof(b), " %14s", Names[i]);
+            s += b;
+        }
+        s += '\n';
+
+        for(uint32_t p = 0; p < PhaseCount; ++p)
+        {
+            Cell c;
+            for(uint32_t d = 0; d < Depths; ++d)
+                c.add(t.cell[d][p]);
+            row(Phases[p], "all", c);
+        }
+
+        for(uint32_t p = 0; p < PhaseCount; ++p)
+        for(uint32_t d = 0; d < Depths; ++d)
+        if(t.cell[d][p].calls)
+        {
+            snprintf(b, sizeof(b), "%u", d);
+            const std::string depth(b);
+            row(Phases[p], depth.c_str(), t.cell[d][p]);
+        }
+        return s;
+    }
+};
+#endif
+
+/**
+ * Charges the scope to the given phase, in a 
+ * profiling build. Compiles away otherwise.
+ *
+ * @tparam Phase the sort phase
+ */
+template<uint32_t Phase>
+struct Measure
+{
+#if defined(BLIPSORT_PROFILE) && defined(__linux__)
+    uint64_t start[Profile::Counters + 1] = { };
+    size_t x;
+
+    constexpr Measure
+        (
+        const size_t x
+        ) : x(x)
+    {
+        if(!std::is_constant_evaluated())
+            Profile::local().read(start);
+    }
+
+    constexpr ~Measure()
+    {
+        if(!std::is_constant_evaluated())
+            Profile::local().charge(Phase, x, start);
+    }
+#else
+    constexpr Measure(size_t) { }
+#endif
+};
+
+/**
+ * Tracks the depth of qSort in the partition 
+ * tree, in a profiling build. Restores the 
+ * depth of the caller on exit.
+ */
+struct Level
+{
+#if defined(BLIPSORT_PROFILE) && defined(__linux__)
+    uint32_t depth = 0;
+
+    constexpr Level()
+    {
+        if(!std::is_constant_evaluated())
+            depth = Profile::local().depth;
+    }
+
+    constexpr void down()
+    {
+        if(!std::is_constant_evaluated())
+            ++Profile::local().depth;
+    }
+
+    constexpr ~Level()
+    {
+        if(!std::is_constant_evaluated())
+            Profile::local().depth = depth;
+    }
+#else
+    constexpr void down() { }
+#endif
+};
+
+/**
+ * Reverses the given interval. Indexes both 
+ * ends from one counter, so the compiler can 
+ * reverse whole vectors at a time.
+ *
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ */
+template<typename E>
+constexpr void reverse
+    (
+    E* const low,
+    E* const high
+    )
+{
+    const size_t h = (high - low + 1) >> 1U;
+    for(size_t i = 0; i < h; ++i)
+    {
+        E e = low[i];
+        low[i] = *(high - i);
+        *(high - i) = e;
+    }
+}
+
+/**
+ * Counts the ascending or equal neighbors in the 
+ * given interval, one block at a time, without 
+ * branching within a block. Exits once there are 
+ * more than ReverseTolerance.
+ *
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @return the count, if at most ReverseTolerance
+ */
+template<typename E, class Cmp>
+constexpr uint32_t reversed
+    (
+    E* const low,
+    E* const high,
+    const Cmp cmp
+    )
+{
+    uint32_t miss = 0;
+    E* i = low;
+    for(; high - i >= BlockSize; i += BlockSize)
+    {
+        uint32_t m = 0;
+        for(size_t j = 0; j < BlockSize; ++j)
+            m += !cmp(i[j + 1], i[j]);
+        if((miss += m) > ReverseTolerance)
+            return miss;
+    }
+    for(; i < high; ++i)
+        miss += !cmp(i[1], *i);
+    return miss;
+}
+
+/**
+ * Turns a reversed interval around once, rather 
+ * than rotating it interval by interval.
+ *
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @return whether the interval was strictly 
+ * descending, and so is now sorted
+ */
+template<typename E, class Cmp>
+constexpr bool unreverse
+    (
+    E* const low,
+    E* const high,
+    const Cmp cmp
+    )
+{
+    const uint32_t miss = reversed(low, high, cmp);
+    if(miss > ReverseTolerance) return false;
+    reverse(low, high);
+    return miss == 0;
+}
+
+/**
+ * Finds a pseudo-median of 3<sup>levels</sup>
+ * elements, stride apart: the median of three 
+ * pseudo-medians of 3<sup>levels - 1</sup>.
+ *
+ * @tparam E the element type
+ * @param p a pointer to the first element
+ * @param stride the distance between elements
+ * @param levels the number of levels
+ * @return a pointer to the pseudo-median
+ */
+template<typename E, class Cmp>
+constexpr E* ninther
+    (
+    E *const p,
+    const size_t stride,
+    const uint32_t levels,
+    const Cmp cmp
+    )
+{
+    if(levels == 0) return p;
+    size_t w = stride;
+    for(uint32_t i = 1; i < levels; ++i) w *= 3;
+    E *const a = ninther(p, stride, levels - 1, cmp),
+      *const b = ninther(p + w, stride, levels - 1, cmp),
+      *const c = ninther(p + (w << 1U), stride, levels - 1, cmp);
+    if(cmp(*a, *b))
+        return cmp(*b, *c) ? b : cmp(*a, *c) ? c : a;
+    return cmp(*a, *c) ? a : cmp(*b, *c) ? c : b;
+}
+
+/**
+ * Selects the pivot for the given interval. Sorts
+ * five candidates in place, such that the middle 
+ * three may be compared against the pivot at left. 
+ * The sample grows with the interval: from 
+ * MedianThreshold, each candidate is first 
+ * replaced by the pseudo-median of its 
+ * neighborhood (3, 9 or 27 elements), so the 
+ * pivot, the descending check and pivot 
+ * retention all see 15, 45 or 135 elements. 
+ * If the candidates are strictly descending, and the
+ * middle is not an ascending run, rotates the 
+ * interval instead. If asked to probe, also checks
+ * whether each inner candidate is followed by a 
+ * smaller element. When all are, the interval is 
+ * likely made of descending runs, which Lomuto 
+ * partitions slowly.
+ *
+ * @tparam Mode the sort mode flags
+ * @tparam Probe whether to look for descending runs
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @param sl receives the left tercile candidate
+ * @param sr receives the right tercile candidate
+ * @param runs receives whether the interval is 
+ * likely made of descending runs
+ * @param seed the generator state (random mode only)
+ * @return a pointer to the middle candidate
+ */
+template<uint32_t Mode, bool Probe, typename E, class Cmp>
+constexpr E* choose
+    (
+    E *const low,
+    E *const high,
+    const Cmp cmp,
+    E *& sl,
+    E *& sr,
+    bool & runs,
+    uint64_t *const seed
+    )
+{
+    // Find an inexpensive
+    // approximation of a third of
+    // the interval.
+    const size_t x = high - low,
+        y = x >> 2U,
+        _3rd = y + (y >> 1U),
+        _6th = _3rd >> 1U;
+
+    // Find an approximate
+    // midpoint of the interval.
+    E *const mid = low + (x >> 1U);
+
+    // Assign tercile indices
+    // to candidate pivots.
+    sl = low  + _3rd;
+    sr = high - _3rd;
+
+    // Assign outer indices
+    // to candidate pivots.
+    E * cl = low  + _6th;
+    E * cr = high - _6th;
+
+    // If we are sorting in random
+    // mode, draw each candidate and
+    // each end from a random spot in
+    // its own neighborhood. The pivot
+    // then depends on the secret seed
+    // rather than on the input, while
+    // the candidates stay spread out
+    // for the descending check.
+    if constexpr (Mode & RandomMode)
+    {
+        const size_t w = _6th | 1U, 
+                     h = w >> 1U;
+        swap(low,  low  + pick(*seed, w));
+        swap(high, high - pick(*seed, w));
+        swap(cl,  (cl  - h) + pick(*seed, w));
+        swap(sl,  (sl  - h) + pick(*seed, w));
+        swap(mid, (mid - h) + pick(*seed, w));
+        swap(sr,  (sr  - h) + pick(*seed, w));
+        swap(cr,  (cr  - h) + pick(*seed, w));
+    }
+
+    // In pointer mode, fetch all
+    // the candidates at once.
+    if constexpr (Mode & PointerMode)
+    {
+        fetch<Mode>(low, 1); fetch<Mode>(cl, 1); 
+        fetch<Mode>(sl, 1);  fetch<Mode>(mid, 1); 
+        fetch<Mode>(sr, 1);  fetch<Mode>(cr, 1); 
+        fetch<Mode>(high, 1);
+    }
+
+    // If probing, check each
+    // inner candidate against
+    // its right neighbor before
+    // the candidates move.
+    runs = false;
+    if constexpr (Probe)
+        runs = 
+            cmp(cl[1],  *cl)  & cmp(sl[1], *sl) & 
+            cmp(mid[1], *mid) & cmp(sr[1], *sr) & 
+            cmp(cr[1],  *cr);
+
+    // On large intervals, swap the
+    // pseudo-median of 3, 9 or 27
+    // elements around each
+    // candidate into its place.
+    // Monotone neighborhoods are
+    // left as they are, so the
+    // checks below still see
+    // descending data.
+    if(x >= MedianThreshold)
+    {
+        const uint32_t v = 1U + 
+            (x >= NintherThreshold) + 
+            (x >= Median27Threshold);
+        const size_t d = _6th >> (v << 2U),
+                     h = d * (v == 1 ? 1 : v == 2 ? 4 : 13);
+        swap(cl,  ninther(cl  - h, d, v, cmp));
+        swap(sl,  ninther(sl  - h, d, v, cmp));
+        swap(mid, ninther(mid - h, d, v, cmp));
+        swap(sr,  ninther(sr  - h, d, v, cmp));
+        swap(cr,  ninther(cr  - h, d, v, cmp));
+    }
+
+    // If the candidates aren't
+    // descending...
+    // Insertion sort all five
+    // candidate pivots in-place.
+    if((!cmp(*cl, *low)) || 
+       (!cmp(*sl, *cl))  ||
+       (!cmp(*mid, *sl)) ||
+       (!cmp(*sr, *mid)) ||
+       (!cmp(*cr, *sr))  ||
+       (!cmp(*high, *cr)))
+    {
+        
+        if(cmp(*low, *cl)) 
+            cl = low;
+        if(cmp(*cr, *high)) 
+            cr = high;
+
+        if (cmp(*sl, *cl)) 
+        {
+            E e = *sl;
+            *sl = *cl;
+            *cl =   e;
+        }
+
+        if (cmp(*mid, *sl)) 
+        {
+            E e  = *mid;
+            *mid =  *sl;
+            *sl  =    e;
+            if (cmp(e, *cl)) 
+            {
+                *sl = *cl;
+                *cl =   e;
+            }
+        }
+
+        if (cmp(*sr, *mid))
+        {
+            E e  =  *sr;
+            *sr  = *mid;
+            *mid =    e;
+            if (cmp(e, *sl))
+            {
+                *mid = *sl;
+                *sl  =   e;
+                if (cmp(e, *cl)) 
+                {
+                    *sl = *cl;
+                    *cl =   e;
+                }
+            }
+        }
+
+        if (cmp(*cr, *sr))
+        {
+            E e = *cr;
+            *cr = *sr;
+            *sr =   e;
+            if (cmp(e, *mid)) 
+            {
+                *sr  = *mid;
+                *mid =    e;
+                if (cmp(e, *sl)) 
+                {
+                    *mid = *sl;
+                    *sl  =   e;
+                    if (cmp(e, *cl)) 
+                    {
+                        *sl = *cl;
+                        *cl =   e;
+                    }
+                }
+            }
+        }
+    }
+
+    // If the candidates are
+    // descending, then the
+    // interval is likely to
+    // be descending somewhat.
+    // It is not made of runs.
+    // Unless the middle is an
+    // ascending run within a
+    // descending sequence of
+    // blocks, rotate the entire
+    // interval around the
+    // midpoint. Rotating such
+    // blocks would only turn
+    // them around, to be 
+    // rotated again below.
+    else
+    {
+        runs = false;
+        if(!cmp(mid[-1], *mid) || 
+           !cmp(*mid, mid[1]))
+            reverse(low, high);
+    }
+
+    return mid;
+}
+
+/**
+ * Partitions the given interval around the pivot
+ * at left, moving elements equal to it to the 
+ * left side. Elements at left must all be less 
+ * than or equal to the pivot at low - 1.
+ *
+ * @tparam Expense whether to use Hoare for fewer moves
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @return a pointer to the first element greater 
+ * than the pivot at left
+ */
+template<bool Expense, typename E, class Cmp>
+constexpr E* partitionLeft
+    (
+    E *const low,
+    E *const high,
+    const Cmp cmp
+    )
+{
+    const E h = *(low - 1);
+    E* l = low - 1,
+     * g = high + 1;
+
+    // skip over data
+    // in place.         
+    while(cmp(h, *--g));
+
+    if(g == high)
+        while(!cmp(h, *++l) && l < g);
+    else 
+        while(!cmp(h, *++l));
+
+    // If we are sorting 
+    // non-arithmetic types,
+    // use Hoare for fewer
+    // moves.
+    if constexpr (Expense)
+    {
+    /**
+     * Partition left by branchful Hoare scheme
+     * 
+     * During partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |    ... == h     |        ... ? ...        |     ... > h     |
+     * +-------------------------------------------------------------+
+     * ^                 ^                         ^                 ^
+     * low               l                         k              high
+     * 
+     * After partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |           ... == h           |            > h ...           |
+     * +-------------------------------------------------------------+
+     * ^                              ^                              ^
+     * low                            l                           high
+     */
+        while(l < g)
+        {
+            swap(l, g);
+            while(cmp(h, *--g));
+            while(!cmp(h, *++l));
+        }
+    }
+
+    // If we are sorting 
+    // arithmetic types,
+    // use branchless lomuto
+    // for fewer branches.
+    else
+    {   
+    /**
+     * Partition left by branchless Lomuto scheme
+     * 
+     * During partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |  ... == h  |  ... > h  | * |     ... ? ...      |  ... > h  |
+     * +-------------------------------------------------------------+
+     * ^            ^           ^                        ^           ^
+     * low          l           k                        g         high
+     * 
+     * After partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |           ... == h           |            > h ...           |
+     * +-------------------------------------------------------------+
+     * ^                              ^                              ^
+     * low                            l                           high
+     */
+        E * k = l, p = *l;
+        while(k < g)
+        {
+            *k = *l;
+            *l = *++k;
+            l += !cmp(h, *l);
+        }
+        *k = *l; *l = p;
+    }
+
+    return l;
+}
+
+/**
+ * Partitions the given interval around the pivot
+ * at mid.
+ *
+ * @tparam Expense whether to use Hoare for fewer moves
+ * @tparam Block whether to use offset blocks
+ * @tparam Mode the sort mode flags
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @param mid a pointer to the pivot
+ * @param work receives whether partitioning moved 
+ * a significant number of elements
+ * @param runs whether the interval is likely made 
+ * of descending runs, to be partitioned by Hoare
+ * @return a pointer to the pivot in its final place
+ */
+template
+<bool Expense, bool Block, uint32_t Mode = 0, typename E, class Cmp>
+constexpr E* partition
+    (
+    E *const low,
+    E *const high,
+    E *const mid,
+    const Cmp cmp,
+    bool & work,
+    const bool runs = false
+    )
+{
+    // If the interval is likely
+    // made of descending runs,
+    // use Hoare, which keeps
+    // them in order, to avoid
+    // Lomuto's slowdown.
+    if constexpr (!Expense)
+    if(runs)
+        return partition<true,Block,Mode>
+            (low, high, mid, cmp, work);
+
+    // Initialize l and k.
+    E *l = ternary<Expense>(low, low - 1),
+      *k = high + 1, * g;
+
+    // Assign midpoint to pivot
+    // variable.
+    const E p = *mid;
+
+    // If we are sorting 
+    // non-arithmetic types, bring 
+    // left end inside. Left end 
+    // will be replaced and pivot 
+    // will be swapped back later.
+    if constexpr(Expense)
+        *mid = *low;
+
+    // skip over data
+    // in place.
+    while(cmp(*++l, p));
+
+    // If we are sorting 
+    // arithmetic types, bring 
+    // left end inside. Left end 
+    // will be replaced and pivot 
+    // will be swapped back later.
+    if constexpr(!Expense)
+        *mid = *l;
+
+    // skip over data
+    // in place.
+    if(ternary<Expense>
+        (l == low + 1, l == low))
+        while(!cmp(*--k, p) && k > l);
+    else 
+        while(!cmp(*--k, p));
+
+    // Will we do a significant 
+    // amount of work during 
+    // partitioning?
+    work = 
+    ((l - low) + (high - k)) 
+        < ((high - low) >> 1U);
+
+    // If we are sorting 
+    // non-arithmetic types and
+    // conserving memory, use 
+    // Hoare for fewer moves.
+    if constexpr (Expense && !Block)
+    {
+    /**
+     * Partition by branchful Hoare scheme
+     * 
+     * During partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |     ... < p     |        ... ? ...        |    ... >= p     |
+     * +-------------------------------------------------------------+
+     * ^                 ^                         ^                 ^
+     * low               l                         k              high
+     * 
+     * After partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |           ... < p            |            >= p ...          |
+     * +-------------------------------------------------------------+
+     * ^                              ^                              ^
+     * low                            l                           high
+     */
+        while(l < k)
+        {
+            swap(l, k);
+            while(cmp(*++l, p));
+            while(!cmp(*--k, p));
+        }
+        *low = *--l; *l = p;
+    }
+
+    // If we are sorting 
+    // non-arithmetic types and
+    // not conserving memory, use 
+    // Block Hoare for fewer moves
+    // and fewer branches.
+    else if constexpr (Expense)
+    {
+    /**
+     * Partition by branchless (Block) Hoare scheme
+     * 
+     * During partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |  ... < p  |   cmp   |   ... ? ...   |   cmp   |  ... >= p   |
+     * +-------------------------------------------------------------+
+     * ^           ^         ^               ^         ^             ^
+     * low         _low      l               k     _high          high
+     * 
+     * After partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |           ... < p            |            >= p ...          |
+     * +-------------------------------------------------------------+
+     * ^                              ^                              ^
+     * low                            l                           high
+     */
+        if(l < k)
+        {
+            swap(l++, k);
+
+            // Set up blocks and
+            // align base pointers to
+            // the cacheline, unless
+            // this is compile time.
+            uint8_t 
+            ols[BlockSize << 1U], 
+            oks[BlockSize << 1U]; 
+            const bool ct = 
+                std::is_constant_evaluated();
+            uint8_t
+            * olp = ct ? ols : align(ols), 
+            * okp = ct ? oks : align(oks); 
+            
+            // Initialize frame pointers.
+            E * _low = l, * _high = k;
+
+            // Initialize offset counts and
+            // start indices for swap routine.
+            size_t nl = 0, nk = 0, ls = 0, ks = 0;
+            
+            while(l < k) 
+            {
+                // If both blocks are empty, split 
+                // the interval in two. Otherwise
+                // give the whole interval to one
+                // block.
+                size_t xx = k - l,
+                lspl = -(nl == 0) & (xx >> (nk == 0)),
+                kspl = -(nk == 0) & (xx - lspl);
+                
+                // In stream mode, fetch the
+                // blocks after next while
+                // these are filled.
+                if constexpr (Mode & StreamMode)
+                {
+                    constexpr size_t Ahead = 
+                        PrefetchBytes / sizeof(E) + 1;
+                    if(lspl >= BlockSize && 
+                       size_t(k - l) > Ahead + BlockSize)
+                        prefetch<Mode>(l + Ahead, BlockSize);
+                    if(kspl >= BlockSize && 
+                       size_t(k - l) > Ahead + BlockSize)
+                        prefetch<Mode>(k - (Ahead + BlockSize), 
+                            BlockSize);
+                }
+
+                // In pointer mode, fetch the
+                // pointees of the next blocks 
+                // while these are compared.
+                if constexpr (Mode & PointerMode)
+                if(size_t(k - l) > (BlockSize << 2U))
+                {
+                    if(lspl >= BlockSize)
+                        fetch<Mode>(l + BlockSize, BlockSize);
+                    if(kspl >= BlockSize)
+                        fetch<Mode>(k - (BlockSize << 1U), 
+                            BlockSize);
+                }
+
+                // Fill the offset blocks. If the split 
+                // for either block is larger than 64,
+                // crop it and unroll the loop. Otherwise,
+                // keep the loop fully rolled. This should
+                // only happen near the end of partitioning.
+                if(lspl >= BlockSize)
+                {
+                    size_t i = -1;
+                    do
+                    {
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                        olp[nl] = ++i; nl += !cmp(*l++, p);
+                    } while(i < BlockSize - 1);
+                }
+                else
+                    for(size_t i = 0; i < lspl; ++i)
+                        olp[nl] = i, nl += !cmp(*l++, p);
+
+                if(kspl >= BlockSize)
+                {
+                    size_t i = 0;
+                    do
+                    {
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                        okp[nk] = ++i; nk += cmp(*--k, p);
+                    } while(i < BlockSize);
+
+                }
+                else
+                    for(size_t i = 0; i < kspl;)
+                        okp[nk] = ++i, nk += cmp(*--k, p);
+
+                // n = min(nl, nk), branchless.
+                size_t n = 
+                    (nl & -(nl < nk)) + (nk & -(nl >= nk));
+
+                // Swap the elements using the offsets. 
+                // Set up working block pointers and lower 
+                // block end pointer.
+                uint8_t* 
+                ll = olp + ls, * kk = okp + ks, * e = ll + n;
+
+                // If the offset counts are equal, we are likely
+                // to be ascending or descending. If ascending,
+                // we don't need to do anything. If descending, 
+                // use swaps to stay O(n). Both blocks must 
+                // contain n offsets. If either block is empty,
+                // fill it and come back.
+                if(nl == nk)
+                    for(; ll < e; ++ll, ++kk)
+                        swap(_low + *ll, _high - *kk);
+
+                // Otherwise, swap using a cyclic permutation.
+                // Both blocks must contain n offsets. If either 
+                // block is empty, fill it and come back.
+                else if(n > 0)
+                {
+                    E* _l = _low + *ll, * _k = _high - *kk;
+                    E t = *_l; *_l = *_k;
+                    for(++ll, ++kk; ll < e; ++ll, ++kk)
+                    {
+                        _l = _low  + *ll; *_k = *_l;
+                        _k = _high - *kk; *_l = *_k;
+                    } 
+                    *_k = t;
+                }
+
+                // Adjust offset counts and starts. If a block
+                // is empty, adjust its frame pointer.
+                nl -= n; nk -= n;
+                if(nl == 0) { ls = 0; _low  = l; } else ls += n; 
+                if(nk == 0) { ks = 0; _high = k; } else ks += n;
+            }
+
+            // swap the remaining elements into place.
+            if(nl)
+            {
+                olp += ls;
+                for(uint8_t* ll = olp + nl;;)
+                {
+                    swap(_low + *--ll, --l); 
+                    if(ll <= olp) break;
+                }
+            }
+
+            if(nk)
+            {
+                okp += ks;
+                for(uint8_t* kk = okp + nk;;)
+                {
+                    swap(_high - *--kk, l++);
+                    if(kk <= okp) break;
+                }
+            }
+        }
+        
+        // Move the pivot into place.
+        *low = *--l; *l = p;
+    }
+
+    // If we are sorting 
+    // arithmetic types, use 
+    // branchless lomuto for 
+    // fewer branches.
+    else
+    {
+    /**
+     * Partition by branchless Lomuto scheme
+     * 
+     * During partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |  ... < p  |  ... >= p  | * |     ... ? ...     |  ... >= p  |
+     * +-------------------------------------------------------------+
+     * ^           ^            ^                       ^            ^
+     * low         l            g                       k         high
+     * 
+     * After partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |           ... < p            |            >= p ...          |
+     * +-------------------------------------------------------------+
+     * ^                              ^                              ^
+     * low                            l                           high
+     */
+        g = l; 
+        
+        // In buffer mode, record the 
+        // offsets of small elements
+        // and move them in batches.
+        if constexpr (Block && (Mode & BufferMode))
+        {
+    /**
+     * Partition by block-buffered Lomuto scheme
+     * 
+     * The hole at l moves right as small elements
+     * fill it, and each one pulls the large element
+     * after the hole back into its old place. That 
+     * is two stores per small element, rather than
+     * two per element.
+     * 
+     * During partitioning:
+     * 
+     * +-------------------------------------------------------------+
+     * |  ... < p  | * |  ... >= p  |  block  |   ... ? ...   | >= p |
+     * +-------------------------------------------------------------+
+     * ^             ^              ^                         ^      ^
+     * low           l              g                         k   high
+     */
+            uint8_t obs[BlockSize << 1U];
+            uint8_t * const ob = 
+                std::is_constant_evaluated() ? 
+                obs : align(obs);
+
+            for(++g; g <= k;)
+            {
+                size_t x = k - g + 1, n = 0;
+
+                // In stream mode, fetch 
+                // the block after next.
+                if constexpr (Mode & StreamMode)
+                if(x > PrefetchBytes / sizeof(E) + BlockSize)
+                    prefetch<Mode>(g + PrefetchBytes / 
+                        sizeof(E), BlockSize);
+
+                // In pointer mode, fetch the
+                // pointees of the next block.
+                if constexpr (Mode & PointerMode)
+                if(x > (BlockSize << 1U))
+                    fetch<Mode>(g + BlockSize, BlockSize);
+
+                // Fill the offset block. Unroll
+                // the loop unless this is the
+                // last block.
+                if(x >= BlockSize)
+                {
+                    size_t i = -1;
+                    do
+                    {
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                        ob[n] = ++i; n += cmp(g[i], p);
+                    } while(i < BlockSize - 1);
+                    x = BlockSize;
+                }
+                else
+                    for(size_t i = 0; i < x; ++i)
+                        ob[n] = i, n += cmp(g[i], p);
+
+                // Fill the hole with each
+                // small element, and refill
+                // it from the front of the 
+                // large run.
+                for(size_t i = 0; i < n; ++i)
+                {
+                    E * const s = g + ob[i];
+                    *l = *s; *s = *++l;
+                }
+                g += x;
+            }
+            *l = p;
+            return l;
+        }
+
+        // If we are not conserving 
+        // memory, unroll the
+        // loop for a tiny boost.
+        if constexpr (Block)
+        {
+            E* u = k - (BlockSize >> 2U);
+            while(g < u)
+            {
+                // In stream mode, fetch 
+                // ahead of g. l trails g
+                // in lines already read.
+                if constexpr (Mode & StreamMode)
+                if(size_t(u - g) > PrefetchBytes / sizeof(E))
+                    prefetch<Mode>(g + PrefetchBytes / 
+                        sizeof(E), BlockSize >> 2U);
+
+                // In pointer mode, fetch the
+                // pointees a window ahead.
+                if constexpr (Mode & PointerMode)
+                if(size_t(u - g) >= PointeeWindow)
+                    fetch<Mode>(g + PointeeWindow, 
+                        BlockSize >> 2U);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+                *g = *l; *l = *++g; l += cmp(*l, p);
+            }
+        }
+
+        while(g < k)
+        {
+            *g = *l;
+            *l = *++g;
+            l += cmp(*l, p);
+        }
+        *g = *l; *l = p;
+    }
+
+    return l;
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Blipsort</i>
+ *  </b>
+ * </h1>
+ *
+ * <h2>Branchless Lomuto</h2>
+ * <p>
+ * The decades-old partitioning algorithm recently 
+ * made a resurgence when researchers discovered 
+ * ways to remove the inner branch. Lukas Bergdoll
+ * and Orson Peters' method— published a little 
+ * under two months ago— is the fastest yet. It 
+ * employs a gap in the data to move elements 
+ * twice per iteration rather than swapping them 
+ * (three moves). For small, trivially copyable 
+ * types, Blipsort employs branchless Lomuto 
+ * partitioning. For other types, Blipsort uses 
+ * branchless or branchful Hoare partitioning.
+ * </p>
+ * 
+ * <h2>Pivot Selectivity</h2>
+ * <p>
+ * Blipsort carefully selects the pivot from the 
+ * middle of five sorted candidates. These 
+ * candidates allow the sort to determine whether 
+ * the data in the current interval is approximately 
+ * descending and inform its "partition left" strategy.
+ * </p>
+ * 
+ * <h2>Insertion Sort</h2>
+ * <p>
+ * Blipsort uses Insertion sort on small intervals 
+ * where asymptotic complexity matters less and 
+ * instruction overhead matters more. Blipsort 
+ * employs Java's Pair Insertion sort on every 
+ * interval except the leftmost. Pair insertion 
+ * sort inserts two elements at a time and doesn't 
+ * need to perform a lower bound check, making it 
+ * slightly faster than normal insertion sort in 
+ * the context of quicksort.
+ * </p>
+ * 
+ * <h2>Pivot Retention</h2>
+ * <p>
+ * Similar to PDQsort, if any of the three middlemost 
+ * candidate pivots is equal to the rightmost element 
+ * of the partition at left, Blipsort moves equal 
+ * elements to the left with branchless Lomuto and 
+ * continues to the right, solving the dutch-flag 
+ * problem and yeilding linear time on data comprised 
+ * of equal elements.
+ * </p> 
+ * 
+ * <h2>Optimism</h2>
+ * <p>
+ * Similar to PDQsort, if the partition is "good" 
+ * (not highly unbalanced), Blipsort switches to 
+ * insertion sort. If the Insertion sort makes more 
+ * than a constant number of moves, Blipsort bails 
+ * and resumes quicksort. This allows Blipsort to 
+ * achieve linear time on already-sorted data.
+ * </p>
+ * 
+ * <h2>Breaking Patterns</h2>
+ * <p>
+ * Like PDQsort, if the partition is bad, Blipsort 
+ * scrambles some elements to break up patterns.
+ * </p>
+ * 
+ * <h2>Rotation</h2>
+ * <p>
+ * When all of the candidate pivots are strictly 
+ * descending, it is very likely that the interval 
+ * is descending as well. Lomuto partitioning slows 
+ * significantly on descending data. Therefore, 
+ * Blipsort neglects to sort descending candidates 
+ * and instead swap-rotates the entire interval 
+ * before partitioning.
+ * </p>
+ *
+ * <h2>Custom Comparators</h2>
+ * <p>
+ * Blipsort allows its user to implement a custom 
+ * boolean comparator. A comparator is best 
+ * implemented with a lambda and no branches. A 
+ * comparator implemented with a lambda can be 
+ * inlined by an optimizing compiler, while a 
+ * comparator implemented with a constexpr/inline 
+ * function typically cannot.
+ * </p>
+ *
+ * @authors Josh Bloch - source
+ * @authors Jon Bently - source
+ * @authors Orson Peters - source
+ * @authors Lukas Bergdoll - source
+ * @authors Stefan Edelkamp - source
+ * @authors Armin Weiß - source
+ * @authors Ellie Moore
+ * @tparam E the element type
+ * @tparam Root whether this is the sort root
+ * @tparam Mode the sort mode flags
+ * @param leftmost whether this is the leftmost part
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @param height the distance of the current sort
+ * tree from the initial height of 2log<sub>2</sub>n
+ * @param seed the generator state (random mode only)
+ */
+template
+<bool Expense, bool Block, bool Root = true, 
+ uint32_t Mode = 0, typename E, class Cmp>
+constexpr void qSort
+    (
+    E * low,
+    E * high,
+    int height,
+    const Cmp cmp,
+    bool leftmost = true,
+    uint64_t *const seed = nullptr
+    ) 
+{
+    // Track the depth, when
+    // profiling.
+    Level level;
+
+    // Tail call loop.
+    for(size_t x = high - low;;) 
+    {
+        // If this is not the
+        // root node, sort the 
+        // interval by insertion
+        // sort if small enough.
+        if constexpr (!Root)
+        if (x < InsertionThreshold) 
+        {
+            // If we are in the Root,
+            // we won't be insertion 
+            // sorting until we 
+            // iterate on the rightmost
+            // part. However, we are
+            // not in the root here, so
+            // we need to be careful
+            // to use guarded insertion
+            // sort if this is the
+            // leftmost partition.
+            Measure<LeafPhase> m(x);
+            fetch<Mode>(low, x + 1);
+            iSort<0,0,0>
+            (low, high, cmp, leftmost);
+            return;
+        }
+
+        // If this is not the root node, 
+        // heap sort when the runtime
+        // trends towards quadratic.
+        if constexpr (!Root)
+        if(height < 0)
+        {
+            Measure<HeapPhase> m(x);
+            return hSort(low, high, cmp);
+        }
+
+        // In stream mode, finish an
+        // interval that fits in L2
+        // in cache, without prefetch.
+        if constexpr (Mode & StreamMode)
+        if(x * sizeof(E) < CacheBytes)
+            return qSort<Expense,Block,Root,
+                Mode & ~uint32_t(StreamMode)>
+            (low, high, height, cmp, leftmost, seed);
+
+        // Select the pivot.
+        E * sl, * sr, * mid; bool runs;
+        {
+            Measure<ChoosePhase> m(x);
+            mid = choose<Mode,!Expense>
+                (low, high, cmp, sl, sr, runs, seed);
+        }
+
+        // If any middle candidate 
+        // pivot is equal to the 
+        // rightmost element of the 
+        // partition to the left,
+        // swap pivot duplicates to 
+        // the side and sort the 
+        // remainder. This is an
+        // alternative to dutch-flag
+        // partitioning.
+        if(!leftmost)
+        {
+            // Check the pivot to 
+            // the left.
+            E h = *(low - 1);
+            if(!cmp(h, *sl)  || 
+               !cmp(h, *mid) || 
+               !cmp(h, *sr))
+            {
+                // Advance low to the
+                // start of the right
+                // partition.
+                {
+                    Measure<PartitionPhase> m(x);
+                    low = partitionLeft
+                    <Expense>(low, high, cmp);
+                }
+                level.down();
+
+                // If we have nothing 
+                // left to sort, return.
+                if(low >= high)
+                    return;
+
+                // Calculate the interval 
+                // width and loop.
+                x = high - low;
+                continue;
+            }
+        }
+
+        // Partition the interval.
+        bool work; E * l, * g;
+        {
+            Measure<PartitionPhase> m(x);
+            l = partition<Expense,Block,Mode>
+                (low, high, mid, cmp, work, runs);
+        }
+        level.down();
+
+        // Skip the pivot.
+        g = l + (l < high);
+        l -= (l > low);
+
+        // Cheaply calculate an
+        // eigth of the interval.
+        const size_t 
+            _8th = x >> 3U;
+
+        // Calculate interval widths.
+        const size_t
+            ls = l - low,
+            gs = high - g;
+
+        // If the partition is fairly 
+        // balanced, try insertion sort.
+        // If insertion sort runtime
+        // trends higher than O(n), fall 
+        // back to quicksort.
+        bool sorted = false;
+        if(ls >= _8th &&
+           gs >= _8th) 
+        {
+            if(!work)
+            {
+                Measure<LeafPhase> m(x);
+                if(iSort<0,0>(low, l, cmp, leftmost)) 
+                {
+                    if(iSort<1,0>(g, high, cmp))
+                        return;
+                    sorted = true;
+                }
+            }
+        }
+
+        // The partition is not balanced.
+        // scramble some elements and
+        // try to break the pattern.
+        else
+        {
+            Measure<ScramblePhase> m(x);
+            if constexpr (Mode & RandomMode)
+            {
+                scramble(low, l, ls, *seed);
+                scramble(g, high, gs, *seed);
+            }
+            else
+            {
+                scramble(low, l, ls);
+                scramble(g, high, gs);
+            }
+
+            // This was a bad partition,
+            // so decrement the height.
+            // When the height is zero,
+            // we will use heapsort.
+            --height;
+        }
+
+        // Sort left portion, unless
+        // insertion sort did.
+        if(!sorted)
+            qSort<Expense,Block,0,Mode>
+            (low, l, height, cmp, leftmost, seed);
+
+        // Sort right portion 
+        // iteratively.
+        low = g;
+
+        // Find the wwidth of the
+        // interval
+        x = high - low;
+
+        // If this is the root,
+        // sort the interval
+        // by insertion sort
+        // if small enough.
+        if constexpr (Root)
+        if (x < InsertionThreshold) 
+        {
+            // If we are in the Root,
+            // insertion sort will
+            // be unguarded.
+            Measure<LeafPhase> m(x);
+            fetch<Mode>(low, x + 1);
+            iSort<1,0,0>(low, high, cmp);
+            return;
+        }
+
+        // If this is the root node, 
+        // heap sort when the runtime
+        // trends towards quadratic.
+        if constexpr (Root)
+        if(height < 0)
+        {
+            Measure<HeapPhase> m(x);
+            return hSort(low, high, cmp);
+        }
+
+        leftmost = false;
+    }
+}
+
+/**
+ * Sorts the given array, once it is known 
+ * to be safe to point one before it.
+ *
+ * @tparam Block whether to use offset blocks
+ * @tparam Mode the sort mode flags
+ * @tparam E the element type
+ * @tparam Cmp the comparator type
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ * @param cmp the comparator
+ * @param seed the secret seed (random mode only)
+ */
+template 
+<bool Block, uint32_t Mode, typename E, class Cmp>
+constexpr void enter
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Cmp cmp,
+    uint64_t & seed
+    ) 
+{
+    if(cnt < InsertionThreshold)
+    {
+        if(cnt > 1)
+            iSort<0,1,0>(a, a + (cnt - 1), cmp);
+        return;
+    }
+
+    // Turn a reversed array around.
+    if(unreverse(a, a + (cnt - 1), cmp))
+        return;
+
+    return qSort
+    <Expensive<E>::value, Block, 1, Mode>
+        (a, a + (cnt - 1), log2(cnt), cmp, true, &seed);
+}
+
+/**
+ * sort 
+ * 
+ * <p>
+ * Usable in constant expressions. At compile 
+ * time the array is sorted in a copy with one 
+ * spare element on the left, since insertion 
+ * sort and partitioning point one before the 
+ * interval, which constant evaluation rejects 
+ * at the start of an array. Cacheline alignment 
+ * and prefetching are skipped.
+ * </p>
+ *
+ * @tparam E the element type
+ * @tparam Cmp the comparator type
+ * @tparam Mode the sort mode flags
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ * @param cmp the comparator
+ * @param seed the secret seed (random mode only)
+ */
+template 
+<bool Block = true, uint32_t Mode = 0, typename E, class Cmp>
+constexpr void blipsort
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Cmp cmp,
+    uint64_t seed = 0
+    ) 
+{
+    if(std::is_constant_evaluated())
+    {
+        if(cnt < 2) return;
+        std::allocator<E> al;
+        E *const b = al.allocate(cnt + 1);
+        std::construct_at(b, a[0]);
+        for(uint32_t i = 0; i < cnt; ++i)
+            std::construct_at(b + (i + 1), a[i]);
+        enter<Block, Mode>(b + 1, cnt, cmp, seed);
+        for(uint32_t i = 0; i < cnt; ++i)
+            a[i] = b[i + 1];
+        std::destroy_n(b, cnt + 1);
+        al.deallocate(b, cnt + 1);
+        return;
+    }
+    enter<Block, Mode>(a, cnt, cmp, seed);
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Antiqsort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Generates an adversarial input for the given sort 
+ * configuration by McIlroy's method. Every element 
+ * starts out as "gas" (greater than any solid value).
+ * When two gas elements are compared, the one that 
+ * looks like a pivot candidate is frozen to the next 
+ * smallest solid value. The sort thereby partitions 
+ * around the worst pivot it could have picked, and the 
+ * resulting values replay that worst case against any 
+ * deterministic configuration. In random mode, the 
+ * input generated for one seed is ordinary data to 
+ * every other seed.
+ * </p>
+ *
+ * @authors M. Douglas McIlroy - source
+ * @authors Ellie Moore
+ * @tparam Block whether to target the block variant
+ * @tparam Mode the sort mode flags to target
+ * @param a the array to receive the adversarial 
+ * input, a permutation of 0..cnt-1
+ * @param cnt the size of the array
+ * @param seed the seed to play against (random mode 
+ * only)
+ */
+template <bool Block = true, uint32_t Mode = 0>
+inline void antiqsort
+    (
+    uint32_t* const a,
+    const uint32_t cnt,
+    const uint64_t seed = 0
+    )
+{
+    if(cnt == 0) return;
+
+    // The sort will see only
+    // indices, while the adversary
+    // decides their values lazily.
+    std::unique_ptr<uint32_t[]> 
+        ix(new uint32_t[cnt]);
+    const uint32_t gas = cnt - 1;
+    for(uint32_t i = 0; i < cnt; ++i)
+        ix[i] = i, a[i] = gas;
+
+    uint32_t solid = 0, candidate = 0;
+    blipsort<Block, Mode>(ix.get(), cnt, 
+        [&](const uint32_t x, const uint32_t y)
+        {
+            if(a[x] == gas && a[y] == gas)
+                a[x == candidate ? x : y] = solid++;
+            if(a[x] == gas) candidate = x;
+            else if(a[y] == gas) candidate = y;
+            return a[x] < a[y];
+        }, 
+    seed);
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Resumable Blipsort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * A blipsort that can be paused between partitions 
+ * and resumed later, for callers with hard latency 
+ * budgets. Rather than recursing, it keeps an explicit 
+ * stack of pending intervals that mirrors the qSort 
+ * recursion: the left part of each partition is 
+ * sorted before the right part. Hence, every element 
+ * to the left of the topmost pending interval is 
+ * already in its final place, and callers may consume 
+ * that sorted prefix before the sort completes.
+ * </p>
+ *
+ * <p>
+ * Each good partition shrinks an interval by at least 
+ * an eighth, and the heap sort fallback allows at most 
+ * log<sub>2</sub>n bad ones. The stack depth is thus 
+ * bounded by log<sub>8/7</sub>n + log<sub>2</sub>n, 
+ * which fits in StackDepth for any 32-bit count.
+ * </p>
+ *
+ * <p>
+ * Without Prefix, the larger part is pushed under 
+ * the smaller one instead. The part sorted next is 
+ * at most half of the interval it came from, so at 
+ * most log<sub>2</sub>n intervals are ever pending, 
+ * whatever the pivots, and a Depth of FiberDepth 
+ * suffices. Pivot retention and unguarded insertion 
+ * sort still hold, since they need only the pivot 
+ * to the left of each part. The sorted elements no 
+ * longer form a prefix, so sorted() is not offered.
+ * </p>
+ *
+ * @author Ellie Moore
+ * @tparam E the element type
+ * @tparam Cmp the comparator type
+ * @tparam Block whether to use offset blocks
+ * @tparam Mode the sort mode flags
+ * @tparam Depth the capacity of the interval stack
+ * @tparam Prefix whether to sort left parts first
+ */
+template 
+<
+    typename E, 
+    class Cmp, 
+    bool Block = true, 
+    uint32_t Mode = 0, 
+    uint32_t Depth = StackDepth, 
+    bool Prefix = true
+>
+class Resumable
+{
+    static constexpr bool Expense = 
+        Expensive<E>::value;
+
+    /**
+     * A pending interval.
+     */
+    struct Interval
+    {
+        E * low;
+        E * high;
+        int height;
+        bool leftmost;
+    };
+
+    E *const a;
+    const uint32_t cnt;
+    const Cmp cmp;
+    uint64_t seed;
+    uint32_t top = 0;
+    Interval stack[Depth];
+
+    /**
+     * Pushes a pending interval.
+     */
+    void push
+        (
+        E *const low,
+        E *const high,
+        const int height,
+        const bool leftmost
+        )
+    {
+        assert(top < Depth);
+        stack[top++] = { low, high, height, leftmost };
+    }
+
+public:
+
+    /**
+     * Prepares to sort the given array. No work 
+     * is done until the first step.
+     *
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     * @param seed the secret seed (random mode only)
+     */
+    Resumable
+        (
+        E *const a,
+        const uint32_t cnt,
+        const Cmp cmp = Cmp(),
+        const uint64_t seed = 0
+        ) : a(a), cnt(cnt), cmp(cmp), seed(seed)
+    {
+        if(cnt > 0)
+            push(a, a + (cnt - 1), log2(cnt), true);
+    }
+
+    /**
+     * Sorts pending intervals until the budget runs 
+     * out or the array is sorted. At least one 
+     * interval is processed per call, and the budget 
+     * is checked between intervals, so a step may 
+     * overrun by one partition pass. The largest 
+     * budget never runs out, and skips the clock.
+     *
+     * @param budget the time budget in nanoseconds
+     * @return whether the array is fully sorted
+     */
+    bool step
+        (
+        const uint64_t budget
+        )
+    {
+        using Clock = std::chrono::steady_clock;
+        const bool timed = 
+            budget != std::numeric_limits<uint64_t>::max();
+        const Clock::time_point start = 
+            timed ? Clock::now() : Clock::time_point();
+
+        while(top > 0)
+        {
+            const Interval i = stack[--top];
+            E * low = i.low, *const high = i.high;
+            int height = i.height;
+
+            // Tail call loop.
+            for(;;)
+            {
+                const size_t x = high - low;
+
+                // Sort small intervals
+                // by insertion sort.
+                if(x < InsertionThreshold)
+                {
+                    iSort<0,0,0>
+                    (low, high, cmp, i.leftmost);
+                    break;
+                }
+
+                // Heap sort when the runtime
+                // trends towards quadratic.
+                if(height < 0)
+                {
+                    hSort(low, high, cmp);
+                    break;
+                }
+
+                // Select the pivot.
+                E * sl, * sr; bool runs;
+                E *const mid = choose<Mode,!Expense>
+                    (low, high, cmp, sl, sr, runs, &seed);
+
+                // Retain the pivot to the
+                // left, as in qSort.
+                if(!i.leftmost)
+                {
+                    E h = *(low - 1);
+                    if(!cmp(h, *sl)  || 
+                       !cmp(h, *mid) || 
+                       !cmp(h, *sr))
+                    {
+                        low = partitionLeft
+                        <Expense>(low, high, cmp);
+                        if(low >= high)
+                            break;
+                        continue;
+                    }
+                }
+
+                // Partition the interval
+                // and skip the pivot.
+                bool work;
+                E *l = partition<Expense,Block,Mode>
+                    (low, high, mid, cmp, work, runs);
+                E *const g = l + (l < high);
+                l -= (l > low);
+
+                const size_t 
+                    _8th = x >> 3U,
+                    ls = l - low,
+                    gs = high - g;
+
+                // If the partition is fairly 
+                // balanced, try insertion sort.
+                if(ls >= _8th && 
+                   gs >= _8th)
+                {
+                    if(!work && iSort<0,0>
+                       (low, l, cmp, i.leftmost))
+                    {
+                        if(!iSort<1,0>(g, high, cmp))
+                            push(g, high, height, false);
+                        break;
+                    }
+                }
+
+                // Otherwise, break patterns
+                // and decrement the height.
+                else
+                {
+                    if constexpr (Mode & RandomMode)
+                    {
+                        scramble(low, l, ls, seed);
+                        scramble(g, high, gs, seed);
+                    }
+                    else
+                    {
+                        scramble(low, l, ls);
+                        scramble(g, high, gs);
+                    }
+                    --height;
+                }
+
+                // Push the right part under
+                // the left part, so that the
+                // left part is sorted first.
+                // Without Prefix, push the
+                // larger part under instead.
+                if(!Prefix && ls > gs)
+                {
+                    push(low, l, height, i.leftmost);
+                    push(g, high, height, false);
+                }
+                else
+                {
+                    push(g, high, height, false);
+                    push(low, l, height, i.leftmost);
+                }
+                break;
+            }
+
+            if(timed &&
+               uint64_t(std::chrono::duration_cast
+               <std::chrono::nanoseconds>
+               (Clock::now() - start).count()) >= budget)
+                break;
+        }
+        return top == 0;
+    }
+
+    /**
+     * @return whether the array is fully sorted
+     */
+    bool done() const
+    {
+        return top == 0;
+    }
+
+    /**
+     * @return the length of the sorted prefix. 
+     * Elements in [0, sorted()) are in their final 
+     * places and will not be moved again.
+     */
+    uint32_t sorted() const requires Prefix
+    {
+        return top == 0 ? cnt : 
+            uint32_t(stack[top - 1].low - a);
+    }
+
+    /**
+     * @return the number of pending intervals
+     */
+    uint32_t pending() const
+    {
+        return top;
+    }
+};
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Fiber Blipsort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts the given array without recursion, for 
+ * fibers and coroutines with small stacks. It 
+ * runs a Resumable to completion, sorting the 
+ * smaller part of each partition first. The 
+ * stack use is fixed: FiberDepth pending 
+ * intervals (under 1KB on 64-bit targets) plus 
+ * the frame of one partition, whose offset 
+ * blocks take 2 * BlockSize bytes.
+ * </p>
+ *
+ * @tparam Block whether to use offset blocks
+ * @tparam Mode the sort mode flags
+ * @tparam E the element type
+ * @tparam Cmp the comparator type
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ * @param cmp the comparator
+ * @param seed the secret seed (random mode only)
+ */
+template 
+<bool Block = true, uint32_t Mode = 0, typename E, class Cmp>
+inline void blipsortFiber
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Cmp cmp,
+    uint64_t seed = 0
+    ) 
+{
+    if(cnt < 2) return;
+    if(cnt < InsertionThreshold)
+    {
+        iSort<0,1,0>(a, a + (cnt - 1), cmp);
+        return;
+    }
+
+    // Turn a reversed array around.
+    if(unreverse(a, a + (cnt - 1), cmp))
+        return;
+
+    Resumable<E, Cmp, Block, Mode, FiberDepth, false> 
+        r(a, cnt, cmp, seed);
+    r.step(std::numeric_limits<uint64_t>::max());
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Trace</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * A timeline of the parallel sorts, for finding 
+ * load imbalance. While started, the async and 
+ * sample sorts record each task, partition, leaf 
+ * sort, classification stripe and bucket with its 
+ * thread, interval bounds, depth and partition 
+ * scheme. Buckets taken from another node's queue 
+ * are marked as steals. Stopped, each record point 
+ * costs one relaxed load.
+ * </p>
+ *
+ * <p>
+ * Each thread claims a buffer of TraceEvents 
+ * records, and only it writes there, so recording 
+ * takes no lock. Buffers are kept when their 
+ * threads exit, and are claimed again by new 
+ * threads, which then share a lane of the 
+ * timeline. A full buffer drops new records and 
+ * counts them. The timeline is written as Chrome 
+ * trace-event JSON, which Perfetto and 
+ * chrome://tracing can open. Write it while no 
+ * sort is running.
+ * </p>
+ */
+struct Trace
+{
+    enum : uint16_t
+    {
+        TaskEvent, PartitionEvent, LeafEvent, 
+        HeapEvent, ClassifyEvent, PermuteEvent, 
+        BucketEvent, EventKinds
+    };
+
+    enum : uint16_t
+    {
+        NoScheme, LomutoScheme, BufferScheme, 
+        HoareScheme, BlockHoareScheme, LeftScheme, 
+        Schemes
+    };
+
+    struct Event
+    {
+        uint64_t begin, end, lo, hi;
+        uint32_t depth;
+        uint16_t kind, scheme;
+        int64_t extra;
+    };
+
+    struct Buffer
+    {
+        Event event[TraceEvents];
+        std::atomic<uint32_t> size{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> owned{true};
+        uint32_t lane = 0;
+        Buffer* next = nullptr;
+
+        void push
+            (
+            const Event & e
+            )
+        {
+            const uint32_t n = 
+                size.load(std::memory_order_relaxed);
+            if(n == TraceEvents)
+            {
+                dropped.fetch_add(1, 
+                    std::memory_order_relaxed);
+                return;
+            }
+            event[n] = e;
+            size.store(n + 1, std::memory_order_release);
+        }
+    };
+
+    static std::atomic<bool> & on()
+    {
+        static std::atomic<bool> o{false};
+        return o;
+    }
+
+    static std::atomic<Buffer*> & head()
+    {
+        static std::atomic<Buffer*> h{nullptr};
+        return h;
+    }
+
+    static uint64_t now()
+    {
+        return uint64_t(std::chrono::duration_cast
+            <std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now()
+            .time_since_epoch()).count());
+    }
+
+    /**
+     * Claims a buffer left by an exited
+     * thread, or pushes a new one.
+     */
+    static Buffer* claim()
+    {
+        for(Buffer* b = head().load
+            (std::memory_order_acquire); b; b = b->next)
+        {
+            bool f = false;
+            if(b->owned.compare_exchange_strong(f, true))
+                return b;
+        }
+        Buffer *const b = new Buffer;
+        Buffer* h = head().load(std::memory_order_relaxed);
+        do 
+        {
+            b->next = h; 
+            b->lane = h ? h->lane + 1 : 1;
+        }
+        while(!head().compare_exchange_weak(h, b, 
+            std::memory_order_release, 
+            std::memory_order_relaxed));
+        return b;
+    }
+
+    static Buffer* buffer()
+    {
+        thread_local struct Hold
+        {
+            Buffer *const b = claim();
+            ~Hold() { b->owned.store(false); }
+        } h;
+        return h.b;
+    }
+
+    /**
+     * Starts recording.
+     */
+    static void start()
+    {
+        on().store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * Stops recording. Recorded events
+     * are kept.
+     */
+    static void stop()
+    {
+        on().store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * Drops all recorded events. Call while
+     * no sort is running.
+     */
+    static void clear()
+    {
+        for(Buffer* b = head().load
+            (std::memory_order_acquire); b; b = b->next)
+        {
+            b->size.store(0, std::memory_order_relaxed);
+            b->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Renders the recorded events.
+     *
+     * @return the events, as Chrome 
+     * trace-event JSON
+     */
+    static std::string json()
+    {
+        constexpr const char* Kinds[EventKinds] =
+        {
+            "task", "partition", "leaf", "heap", 
+            "classify", "permute", "bucket"
+        };
+        constexpr const char* Names[Schemes] =
+        {
+            "", "lomuto", "buffered lomuto", "hoare", 
+            "block hoare", "left"
+        };
+
+        // Timestamps are in microseconds,
+        // from the earliest event.
+        uint64_t t0 = ~uint64_t(0);
+        for(Buffer* b = head().load
+            (std::memory_order_acquire); b; b = b->next)
+        {
+            const uint32_t n = 
+                b->size.load(std::memory_order_acquire);
+            for(uint32_t i = 0; i < n; ++i)
+                if(b->event[i].begin < t0) 
+                    t0 = b->event[i].begin;
+        }
+
+        const auto us = [](const uint64_t d)
+        {
+            const std::string f = std::to_string(d % 1000U);
+            return std::to_string(d / 1000U) + "." + 
+                std::string(3 - f.size(), '0') + f;
+        };
+
+        std::string s = "{\"traceEvents\":[";
+        bool first = true;
+        const auto comma = [&]
+        {
+            if(!first) s += ",";
+            first = false;
+            s += "\n";
+        };
+
+        for(Buffer* b = head().load
+            (std::memory_order_acquire); b; b = b->next)
+        {
+            const std::string tid = std::to_string(b->lane);
+            comma();
+            s += "{\"name\":\"thread_name\",\"ph\":\"M\","
+                 "\"pid\":1,\"tid\":" + tid + ",\"args\":"
+                 "{\"name\":\"blipsort " + tid + "\"}}";
+
+            const uint32_t n = 
+                b->size.load(std::memory_order_acquire);
+            for(uint32_t i = 0; i < n; ++i)
+            {
+                const Event & e = b->event[i];
+                comma();
+                s += "{\"name\":\"";
+                s += Kinds[e.kind];
+                s += "\",\"cat\":\"blipsort\",\"ph\":\"X\""
+                     ",\"pid\":1,\"tid\":" + tid + 
+                     ",\"ts\":" + us(e.begin - t0) + 
+                     ",\"dur\":" + us(e.end - e.begin) + 
+                     ",\"args\":{\"lo\":" + std::to_string(e.lo) + 
+                     ",\"hi\":" + std::to_string(e.hi) + 
+                     ",\"depth\":" + std::to_string(e.depth);
+                if(e.scheme != NoScheme)
+                {
+                    s += ",\"scheme\":\"";
+                    s += Names[e.scheme];
+                    s += "\"";
+                }
+                if(e.kind == BucketEvent)
+                {
+                    s += ",\"bucket\":" + 
+                        std::to_string(e.extra >> 1) + 
+                        ",\"steal\":";
+                    s += e.extra & 1 ? "true" : "false";
+                }
+                s += "}}";
+            }
+
+            const uint64_t d = 
+                b->dropped.load(std::memory_order_relaxed);
+            if(d)
+            {
+                comma();
+                s += "{\"name\":\"dropped\",\"ph\":\"C\","
+                     "\"pid\":1,\"tid\":" + tid + 
+                     ",\"ts\":0,\"args\":{\"events\":" + 
+                     std::to_string(d) + "}}";
+            }
+        }
+        s += "\n]}\n";
+        return s;
+    }
+
+    /**
+     * Writes the recorded events to the given
+     * file, as Chrome trace-event JSON.
+     *
+     * @param path the path of the file
+     * @return whether the file was written
+     */
+    static bool write
+        (
+        const std::string & path
+        )
+    {
+        std::ofstream f(path);
+        f << json();
+        return bool(f);
+    }
+
+    /**
+     * Finds the scheme partition will use.
+     *
+     * @tparam Expense whether to use Hoare for fewer moves
+     * @tparam Block whether to use offset blocks
+     * @tparam Mode the sort mode flags
+     * @param runs whether the interval is likely
+     * made of descending runs
+     * @return the scheme
+     */
+    template<bool Expense, bool Block, uint32_t Mode>
+    static uint16_t scheme
+        (
+        const bool runs
+        )
+    {
+        if(Expense || runs)
+            return Block ? BlockHoareScheme : HoareScheme;
+        return Block && (Mode & BufferMode) ? 
+            BufferScheme : LomutoScheme;
+    }
+};
+
+/**
+ * Records its scope as one event on the
+ * timeline, while the trace is started.
+ */
+struct Span
+{
+    Trace::Buffer* b = nullptr;
+    Trace::Event e;
+
+    Span
+        (
+        const uint16_t kind,
+        const uint64_t lo,
+        const uint64_t hi,
+        const uint32_t depth = 0,
+        const uint16_t scheme = Trace::NoScheme,
+        const int64_t extra = 0
+        )
+    {
+        if(!Trace::on().load(std::memory_order_relaxed))
+            return;
+        b = Trace::buffer();
+        e = { Trace::now(), 0, lo, hi, depth, 
+              kind, scheme, extra };
+    }
+
+    /**
+     * Sets the scheme, once it is known.
+     */
+    void set
+        (
+        const uint16_t scheme
+        )
+    {
+        e.scheme = scheme;
+    }
+
+    /**
+     * Records the event now, rather
+     * than at the end of the scope.
+     */
+    void end()
+    {
+        if(b == nullptr) return;
+        e.end = Trace::now();
+        b->push(e);
+        b = nullptr;
+    }
+
+    ~Span() { end(); }
+};
+
+/**
+ * The shared state of an asynchronous sort.
+ *
+ * @tparam Cmp the comparator type
+ * @tparam Exec the executor type
+ */
+template<class Cmp, class Exec>
+struct AsyncState
+{
+    std::promise<void> promise;
+    std::exception_ptr error;
+    std::atomic<uint32_t> tasks;
+    std::atomic<bool> failed;
+    const Cmp cmp;
+    Exec exec;
+    uintptr_t base = 0;
+
+    AsyncState
+        (
+        const Cmp cmp,
+        const Exec exec
+        ) : tasks(1), failed(false), cmp(cmp), exec(exec)
+    { }
+};
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Asynchronous Sort Task</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts the given interval as one task of an 
+ * asynchronous sort. While the interval is larger 
+ * than TaskThreshold, partitions it as qSort does, 
+ * hands the right part to the executor as a new task 
+ * and continues on the left part. Smaller intervals 
+ * are finished by qSort on the current thread. The 
+ * last task to finish fulfills the promise, so that 
+ * no task touches the array once the future is ready, 
+ * even if the comparator threw.
+ * </p>
+ *
+ * @tparam Expense whether to use Hoare for fewer moves
+ * @tparam Block whether to use offset blocks
+ * @tparam Mode the sort mode flags
+ * @tparam E the element type
+ * @param s the shared state
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @param height the distance of the current sort
+ * tree from the initial height of 2log<sub>2</sub>n
+ * @param leftmost whether this is the leftmost part
+ * @param seed the generator state (random mode only)
+ * @param depth the depth in the partition tree
+ */
+template
+<bool Expense, bool Block, uint32_t Mode, 
+ typename E, class Cmp, class Exec>
+inline void aSort
+    (
+    const std::shared_ptr<AsyncState<Cmp, Exec>> s,
+    E * low,
+    E * high,
+    int height,
+    bool leftmost,
+    uint64_t seed,
+    uint32_t depth = 0
+    )
+{
+    const Cmp cmp = s->cmp;
+
+    // Finds the index of p,
+    // for the trace.
+    const auto at = [&s](const E *const p)
+    {
+        return uint64_t((uintptr_t(p) - s->base) / sizeof(E));
+    };
+
+    Span task(Trace::TaskEvent, at(low), at(high), depth);
+    try
+    {
+        // Stop early if another
+        // task has failed.
+        while(!s->failed.load
+              (std::memory_order_relaxed))
+        {
+            const size_t x = high - low;
+
+            // Finish small intervals
+            // on this thread.
+            if(x < TaskThreshold)
+            {
+                Span leaf(Trace::LeafEvent, 
+                    at(low), at(high), depth);
+                qSort<Expense,Block,0,Mode>
+                (low, high, height, cmp, leftmost, &seed);
+                break;
+            }
+
+            // Heap sort when the runtime
+            // trends towards quadratic.
+            if(height < 0)
+            {
+                Span heap(Trace::HeapEvent, 
+                    at(low), at(high), depth);
+                hSort(low, high, cmp);
+                break;
+            }
+
+            Span part(Trace::PartitionEvent, 
+                at(low), at(high), depth++);
+
+            // Select the pivot.
+            E * sl, * sr; bool runs;
+            E *const mid = choose<Mode,!Expense>
+                (low, high, cmp, sl, sr, runs, &seed);
+
+            // Retain the pivot to the
+            // left, as in qSort.
+            if(!leftmost)
+            {
+                E h = *(low - 1);
+                if(!cmp(h, *sl)  || 
+                   !cmp(h, *mid) || 
+                   !cmp(h, *sr))
+                {
+                    part.set(Trace::LeftScheme);
+                    low = partitionLeft
+                    <Expense>(low, high, cmp);
+                    if(low >= high)
+                        break;
+                    continue;
+                }
+            }
+
+            // Partition the interval
+            // and skip the pivot.
+            part.set(Trace::scheme
+                <Expense,Block,Mode>(runs));
+            bool work;
+            E *l = partition<Expense,Block,Mode>
+                (low, high, mid, cmp, work, runs);
+            E *const g = l + (l < high);
+            l -= (l > low);
+
+            const size_t 
+                _8th = x >> 3U,
+                ls = l - low,
+                gs = high - g;
+
+            // If the partition is fairly 
+            // balanced, try insertion sort.
+            if(ls >= _8th && 
+               gs >= _8th)
+            {
+                if(!work && iSort<0,0>
+                   (low, l, cmp, leftmost))
+                {
+                    if(iSort<1,0>(g, high, cmp))
+                        break;
+                    low = g;
+                    leftmost = false;
+                    continue;
+                }
+            }
+
+            // Otherwise, break patterns
+            // and decrement the height.
+            else
+            {
+                if constexpr (Mode & RandomMode)
+                {
+                    scramble(low, l, ls, seed);
+                    scramble(g, high, gs, seed);
+                }
+                else
+                {
+                    scramble(low, l, ls);
+                    scramble(g, high, gs);
+                }
+                --height;
+            }
+
+            // Hand the right part to
+            // the executor and continue
+            // on the left part. If the
+            // executor refuses the task,
+            // take back its count, so 
+            // the error reaches the
+            // future.
+            s->tasks.fetch_add
+                (1, std::memory_order_relaxed);
+            const uint64_t z = splitMix(seed);
+            try
+            {
+                s->exec([s, g, high, height, z, depth]
+                {
+                    aSort<Expense,Block,Mode>
+                    (s, g, high, height, false, z, depth);
+                });
+            }
+            catch(...)
+            {
+                s->tasks.fetch_sub
+                    (1, std::memory_order_relaxed);
+                throw;
+            }
+            high = l;
+        }
+    }
+    catch(...)
+    {
+        if(!s->failed.exchange(true))
+            s->error = std::current_exception();
+    }
+
+    // The last task to finish
+    // fulfills the promise.
+    if(s->tasks.fetch_sub
+       (1, std::memory_order_acq_rel) == 1)
+    {
+        if(s->error)
+            s->promise.set_exception(s->error);
+        else
+            s->promise.set_value();
+    }
+}
+
+/**
+ * sort asynchronously
+ * 
+ * @tparam E the element type
+ * @tparam Cmp the comparator type
+ * @tparam Exec the executor type
+ * @tparam Mode the sort mode flags
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ * @param cmp the comparator
+ * @param exec the executor
+ * @param seed the secret seed (random mode only)
+ * @return a future that becomes ready when the 
+ * array is sorted
+ */
+template 
+<bool Block = true, uint32_t Mode = 0, 
+ typename E, class Cmp, class Exec>
+inline std::future<void> blipsortAsync
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Cmp cmp,
+    const Exec exec,
+    const uint64_t seed = 0
+    ) 
+{
+    const std::shared_ptr<AsyncState<Cmp, Exec>> 
+        s = std::make_shared<AsyncState<Cmp, Exec>>(cmp, exec);
+    std::future<void> f = s->promise.get_future();
+    s->base = uintptr_t(a);
+    if(cnt == 0)
+    {
+        s->promise.set_value();
+        return f;
+    }
+    s->exec([s, a, cnt, seed]
+    {
+        aSort
+        <Expensive<E>::value, Block, Mode>
+            (s, a, a + (cnt - 1), log2(cnt), true, seed);
+    });
+    return f;
+}
+
+/**
+ * The unsigned key type of the same width
+ * as the given floating point type.
+ */
+template<typename F>
+using FloatKey = typename std::conditional
+    <sizeof(F) == 4, uint32_t, uint64_t>::type;
+
+/**
+ * Maps the bits of a float to an unsigned key
+ * whose order is the IEEE total order: flips
+ * all bits of negatives and only the sign bit 
+ * of positives.
+ *
+ * @tparam K the key type
+ * @param u the bits of the float
+ */
+template<typename K>
+constexpr K toKey
+    (
+    const K u
+    )
+{
+    constexpr K Sign = K(1) << (sizeof(K) * 8 - 1);
+    return u ^ (K(-K(u >> (sizeof(K) * 8 - 1))) | Sign);
+}
+
+/**
+ * Inverts toKey.
+ *
+ * @tparam K the key type
+ * @param k the key
+ */
+template<typename K>
+constexpr K fromKey
+    (
+    const K k
+    )
+{
+    constexpr K Sign = K(1) << (sizeof(K) * 8 - 1);
+    return k ^ (K((k >> (sizeof(K) * 8 - 1)) - 1) | Sign);
+}
+
+/**
+ * Whether a float may hold the bits of a key.
+ * Keys are stored back into the array as floats,
+ * through std::bit_cast, so that the array is
+ * never accessed as integers. x87 may quiet the
+ * NaN-shaped keys when it copies them, so there
+ * the keys are computed in the comparator instead.
+ */
+#if (defined(__i386__) && !defined(__SSE2_MATH__)) || \
+    (defined(_M_IX86) && _M_IX86_FP < 2)
+constexpr bool KeysInFloats = false;
+#else
+constexpr bool KeysInFloats = true;
+#endif
+
+/**
+ * Maps a float to a float holding its key.
+ *
+ * @tparam F the floating point type
+ * @param f the float
+ */
+template<typename F>
+constexpr F floatKey
+    (
+    const F f
+    )
+{
+    if constexpr (KeysInFloats)
+        return std::bit_cast<F>
+            (toKey(std::bit_cast<FloatKey<F>>(f)));
+    else return f;
+}
+
+/**
+ * Inverts floatKey.
+ *
+ * @tparam F the floating point type
+ * @param k the float holding a key
+ */
+template<typename F>
+constexpr F floatValue
+    (
+    const F k
+    )
+{
+    if constexpr (KeysInFloats)
+        return std::bit_cast<F>
+            (fromKey(std::bit_cast<FloatKey<F>>(k)));
+    else return k;
+}
+
+/**
+ * Orders floats mapped by floatKey.
+ *
+ * @tparam F the floating point type
+ */
+template<typename F>
+struct FloatLess
+{
+    constexpr bool operator()
+        (
+        const F x,
+        const F y
+        ) const
+    {
+        using K = FloatKey<F>;
+        const K u = std::bit_cast<K>(x);
+        const K v = std::bit_cast<K>(y);
+        if constexpr (KeysInFloats) 
+            return u < v;
+        else return toKey(u) < toKey(v);
+    }
+};
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Float Sort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts floats or doubles in ascending order by 
+ * their bits. A pre-pass maps each value to an 
+ * order-preserving unsigned key in place and moves 
+ * NaNs to the end chosen by the policy. The keys 
+ * are then sorted with the integer kernels and 
+ * mapped back. Keys are held in the array as 
+ * floats (see floatKey), so the array is never 
+ * aliased as integers. Unlike std::less, the 
+ * result is well-defined in the presence of NaNs.
+ * </p>
+ *
+ * <p>
+ * With TotalOrder, NaNs are not moved: negative 
+ * NaNs sort first and positive NaNs last, as in 
+ * IEEE 754 totalOrder. With MergeZeros, -0.0 is 
+ * rewritten as +0.0. Otherwise, -0.0 sorts before 
+ * +0.0 and all bits are preserved.
+ * </p>
+ *
+ * @tparam Policy the float policy flags
+ * @tparam Block whether to use offset blocks
+ * @tparam F the floating point type
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ */
+template 
+<uint32_t Policy = NaNsLast, bool Block = true, typename F>
+inline void blipsortFloat
+    (
+    F* const a,
+    const uint32_t cnt
+    )
+{
+    static_assert(std::is_floating_point<F>::value && 
+        std::numeric_limits<F>::is_iec559 &&
+        (sizeof(F) == 4 || sizeof(F) == 8),
+        "blipsortFloat requires IEEE float or double");
+
+    using K = FloatKey<F>;
+    constexpr K Sign = K(1) << (sizeof(K) * 8 - 1);
+    constexpr K Inf = 
+        std::bit_cast<K>(std::numeric_limits<F>::infinity());
+    F * low = a, * high = a + cnt;
+
+    // Map each value to its key. 
+    // Move NaNs to one end unless
+    // the total order is wanted.
+    if constexpr (Policy & TotalOrder)
+    {
+        for(F* i = low; i < high; ++i)
+        {
+            K u = std::bit_cast<K>(*i);
+            if constexpr (Policy & MergeZeros)
+                u &= -K(u != Sign);
+            *i = floatKey(std::bit_cast<F>(u));
+        }
+    }
+    else if constexpr (Policy & NaNsFirst)
+    {
+        for(F* i = high; i > low;)
+        {
+            const F f = *--i;
+            K u = std::bit_cast<K>(f);
+            if((u & ~Sign) > Inf)
+            {
+                *i++ = *low; 
+                *low++ = f;
+                continue;
+            }
+            if constexpr (Policy & MergeZeros)
+                u &= -K(u != Sign);
+            *i = floatKey(std::bit_cast<F>(u));
+        }
+    }
+    else
+    {
+        for(F* i = low; i < high;)
+        {
+            const F f = *i;
+            K u = std::bit_cast<K>(f);
+            if((u & ~Sign) > Inf)
+            {
+                *i = *--high; 
+                *high = f;
+                continue;
+            }
+            if constexpr (Policy & MergeZeros)
+                u &= -K(u != Sign);
+            *i++ = floatKey(std::bit_cast<F>(u));
+        }
+    }
+
+    // Sort the keys with the
+    // integer kernels.
+    if(high - low > 1)
+        blipsort<Block>
+        (low, uint32_t(high - low), FloatLess<F>());
+
+    // Map the keys back.
+    for(F* i = low; i < high; ++i)
+        *i = floatValue(*i);
+}
+
+/**
+ * Marks a sort key for descending order.
+ *
+ * @tparam Key the key projection type
+ */
+template<class Key>
+struct Descending
+{
+    Key key;
+};
+
+/**
+ * Key projection traits. A key is any callable
+ * (or member pointer) that maps an element to 
+ * a value ordered by operator&lt;.
+ *
+ * @tparam Key the key projection type
+ * @tparam E the element type
+ */
+template<class Key, typename E>
+struct KeyTraits
+{
+    using Value = std::decay_t
+        <std::invoke_result_t<const Key&, const E&>>;
+    static constexpr bool Desc = false;
+
+    static constexpr decltype(auto) get
+        (
+        const Key & k,
+        const E & e
+        )
+    {
+        return std::invoke(k, e);
+    }
+};
+
+template<class Key, typename E>
+struct KeyTraits<Descending<Key>, E>
+{
+    using Value = typename KeyTraits<Key, E>::Value;
+    static constexpr bool Desc = true;
+
+    static constexpr decltype(auto) get
+        (
+        const Descending<Key> & k,
+        const E & e
+        )
+    {
+        return std::invoke(k.key, e);
+    }
+};
+
+/**
+ * The width in bits of a key if it may be packed
+ * into a normalized unsigned integer, else zero.
+ *
+ * @tparam Key the key projection type
+ * @tparam E the element type
+ */
+template<class Key, typename E>
+constexpr size_t keyBits()
+{
+    using V = typename KeyTraits<Key, E>::Value;
+    if constexpr (std::is_floating_point<V>::value)
+        return (sizeof(V) == 4 || sizeof(V) == 8) && 
+            std::numeric_limits<V>::is_iec559 ? 
+                sizeof(V) * 8 : 0;
+    else
+        return std::is_arithmetic<V>::value ? 
+            sizeof(V) * 8 : 0;
+}
+
+/**
+ * The number of leading keys that may be packed
+ * together into 64 bits.
+ *
+ * @tparam E the element type
+ * @tparam Keys the key projection types
+ */
+template<typename E, class... Keys>
+constexpr size_t packCount()
+{
+    constexpr size_t w[] = { keyBits<Keys, E>()... };
+    size_t n = 0, b = 0;
+    for(; n < sizeof...(Keys); ++n)
+    {
+        if(w[n] == 0 || b + w[n] > 64) break;
+        b += w[n];
+    }
+    return n;
+}
+
+/**
+ * The total width in bits of the first N keys.
+ *
+ * @tparam N the number of keys
+ * @tparam E the element type
+ * @tparam Keys the key projection types
+ */
+template<size_t N, typename E, class... Keys>
+constexpr size_t packBits()
+{
+    constexpr size_t w[] = { keyBits<Keys, E>()... };
+    size_t b = 0;
+    for(size_t i = 0; i < N; ++i) b += w[i];
+    return b;
+}
+
+/**
+ * Maps a key value to an unsigned integer of the
+ * same width whose order is the key order. Flips 
+ * the sign bit of signed integers, maps floats by
+ * toKey and inverts descending keys.
+ *
+ * @tparam Key the key projection type
+ * @tparam E the element type
+ * @param k the key projection
+ * @param e the element
+ */
+template<class Key, typename E>
+constexpr uint64_t normalize
+    (
+    const Key & k,
+    const E & e
+    )
+{
+    using T = KeyTraits<Key, E>;
+    using V = typename T::Value;
+    using U = typename std::conditional<sizeof(V) == 1, uint8_t,
+              typename std::conditional<sizeof(V) == 2, uint16_t,
+              typename std::conditional<sizeof(V) == 4, uint32_t, 
+                  uint64_t>::type>::type>::type;
+    constexpr size_t W = sizeof(V) * 8;
+
+    U u = std::bit_cast<U>(V(T::get(k, e)));
+    if constexpr (std::is_floating_point<V>::value)
+        u = toKey(u);
+    else if constexpr (std::is_signed<V>::value)
+        u ^= U(U(1) << (W - 1));
+    if constexpr (T::Desc)
+        u = U(~u);
+    return u;
+}
+
+/**
+ * Packs the first N keys of an element into one
+ * normalized integer, leading key uppermost.
+ *
+ * @tparam E the element type
+ * @tparam Keys the key projection types
+ * @param e the element
+ * @param keys the key projections
+ */
+template<typename E, class... Keys, size_t... I>
+constexpr uint64_t pack
+    (
+    const E & e,
+    const std::tuple<const Keys&...> & keys,
+    std::index_sequence<I...>
+    )
+{
+    uint64_t k = 0;
+    ((k = (keyBits<std::tuple_element_t
+        <I, std::tuple<Keys...>>, E>() == 64 ? 0 : 
+        k << keyBits<std::tuple_element_t
+        <I, std::tuple<Keys...>>, E>()) | 
+        normalize(std::get<I>(keys), e)), ...);
+    return k;
+}
+
+/**
+ * Sorts the given array by the given keys, one 
+ * column at a time. Sorts by the first key, then 
+ * re-sorts only the ranges tied on it by the 
+ * remaining keys. Floats that may be packed are 
+ * compared by their keys, as when packed, so the 
+ * order does not depend on the path taken.
+ *
+ * @tparam E the element type
+ * @tparam Key the leading key projection type
+ * @tparam Keys the remaining key projection types
+ * @param a the array to be sorted
+ * @param cnt the size of the array
+ * @param key the leading key projection
+ * @param keys the remaining key projections
+ */
+template<typename E, class Key, class... Keys>
+inline void refine
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Key & key,
+    const Keys &... keys
+    )
+{
+    using T = KeyTraits<Key, E>;
+    using V = typename T::Value;
+    const auto cmp = [&key](const E & x, const E & y)
+    {
+        if constexpr (std::is_floating_point<V>::value &&
+                      keyBits<Key, E>() > 0)
+        {
+            const V u = floatKey(V(T::get(key, x))),
+                    v = floatKey(V(T::get(key, y)));
+            return T::Desc ? 
+                FloatLess<V>()(v, u) : FloatLess<V>()(u, v);
+        }
+        else if constexpr (T::Desc)
+            return T::get(key, y) < T::get(key, x);
+        else
+            return T::get(key, x) < T::get(key, y);
+    };
+    blipsort(a, cnt, cmp);
+
+    // Refine each tied range
+    // by the remaining keys.
+    if constexpr (sizeof...(Keys) > 0)
+    for(uint32_t i = 0, j = 1; j <= cnt; ++j)
+    {
+        if(j < cnt && !cmp(a[j - 1], a[j]))
+            continue;
+        if(j - i > 1)
+            refine(a + i, j - i, keys...);
+        i = j;
+    }
+}
+
+/**
+ * Shifts an index sequence by O.
+ */
+template<size_t O, size_t... I>
+constexpr std::index_sequence<(O + I)...> offsetSequence
+    (
+    std::index_sequence<I...>
+    )
+{
+    return {};
+}
+
+/**
+ * Refines the ranges of the array that are tied 
+ * on their packed keys by the remaining keys.
+ *
+ * @tparam E the element type
+ * @tparam Key a functor from index to packed key
+ * @tparam Keys the key projection types
+ * @param a the array to be refined
+ * @param cnt the size of the array
+ * @param packed the packed key accessor
+ * @param keys the key projections
+ */
+template<typename E, class Key, class... Keys, size_t... I>
+inline void refineTies
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Key packed,
+    const std::tuple<const Keys&...> & keys,
+    std::index_sequence<I...>
+    )
+{
+    for(uint32_t i = 0, j = 1; j <= cnt; ++j)
+    {
+        if(j < cnt && packed(j - 1) == packed(j))
+            continue;
+        if(j - i > 1)
+            refine(a + i, j - i, std::get<I>(keys)...);
+        i = j;
+    }
+}
+
+/**
+ * Moves each element of the array to its sorted 
+ * place by following the cycles of a permutation.
+ * Position j receives the element at src(j). 
+ * Visited positions are marked by set(j).
+ *
+ * @tparam E the element type
+ * @param a the array to be permuted
+ * @param cnt the size of the array
+ * @param src the source index accessor
+ * @param set the marker
+ */
+template<typename E, class Src, class Set>
+inline void permute
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Src src,
+    const Set set
+    )
+{
+    for(uint32_t j = 0; j < cnt; ++j)
+    {
+        uint32_t s = src(j);
+        if(s == j) continue;
+        E t = a[j];
+        uint32_t k = j;
+        do
+        {
+            a[k] = a[s]; 
+            set(k);
+            k = s; 
+            s = src(k);
+        } while(s != j);
+        a[k] = t;
+        set(k);
+    }
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Multi-Column Sort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts the given array lexicographically by the 
+ * given keys. The leading keys with arithmetic 
+ * values are packed into one normalized integer 
+ * per element: signed integers have their sign 
+ * bits flipped, floats are mapped by toKey and 
+ * descending keys are inverted. When the packed 
+ * width leaves room for a 32-bit index, the key 
+ * and the index share one uint64_t and are sorted 
+ * by the integer path. Otherwise, (key, index) 
+ * pairs are sorted. The elements are then moved 
+ * into place by cycle-following, and the ranges 
+ * tied on the packed key are refined by the 
+ * remaining keys one column at a time. If the 
+ * leading key can not be packed, the whole sort 
+ * is column at a time.
+ * </p>
+ *
+ * <p>
+ * The packed path takes 8 or 16 bytes of 
+ * scratch per element from the arena. When the 
+ * arena can not supply it, the sort falls back 
+ * to column at a time, which needs none.
+ * </p>
+ *
+ * @tparam Arena the scratch arena policy
+ * @tparam E the element type
+ * @tparam Keys the key projection types
+ * @param a the array to be sorted
+ * @param cnt the size of the array
+ * @param keys the key projections
+ */
+template<class Arena = HeapArena, typename E, class... Keys>
+inline void blipsortMulti
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Keys &... keys
+    )
+{
+    static_assert(sizeof...(Keys) > 0, 
+        "blipsortMulti requires at least one key");
+    if(cnt < 2) return;
+
+    constexpr size_t N = sizeof...(Keys),
+        P = packCount<E, Keys...>(),
+        B = packBits<P, E, Keys...>();
+
+    if constexpr (P == 0)
+        refine(a, cnt, keys...);
+    else
+    {
+        const std::tuple<const Keys&...> t(keys...);
+        Arena arena;
+
+        // The packed key and the index
+        // fit in one word.
+        if constexpr (B <= 32)
+        {
+            Scratch<uint64_t, Arena> w(arena, cnt);
+            if(!w) return refine(a, cnt, keys...);
+            for(uint32_t i = 0; i < cnt; ++i)
+                w[i] = pack(a[i], t, 
+                    std::make_index_sequence<P>()) 
+                        << 32U | i;
+            blipsort(w.get(), cnt, std::less<>());
+
+            permute(a, cnt, 
+                [&w](const uint32_t j) 
+                { return uint32_t(w[j]); },
+                [&w](const uint32_t j) 
+                { w[j] = (w[j] >> 32U << 32U) | j; });
+
+            if constexpr (P < N)
+            refineTies(a, cnt, 
+                [&w](const uint32_t j) 
+                { return w[j] >> 32U; }, 
+                t, offsetSequence<P>
+                    (std::make_index_sequence<N - P>()));
+        }
+
+        // The packed key needs 
+        // a word of its own.
+        else
+        {
+            struct Pair 
+            { 
+                uint64_t key; 
+                uint32_t idx; 
+            };
+            Scratch<Pair, Arena> w(arena, cnt);
+            if(!w) return refine(a, cnt, keys...);
+            for(uint32_t i = 0; i < cnt; ++i)
+                w[i] = { pack(a[i], t, 
+                    std::make_index_sequence<P>()), i };
+            blipsort(w.get(), cnt, 
+                [](const Pair & x, const Pair & y)
+                { return x.key < y.key; });
+
+            permute(a, cnt, 
+                [&w](const uint32_t j) 
+                { return w[j].idx; },
+                [&w](const uint32_t j) 
+                { w[j].idx = j; });
+
+            if constexpr (P < N)
+            refineTies(a, cnt, 
+                [&w](const uint32_t j) 
+                { return w[j].key; }, 
+                t, offsetSequence<P>
+                    (std::make_index_sequence<N - P>()));
+        }
+    }
+}
+
+/**
+ * Appends the sorted interval to the unique 
+ * prefix at out, dropping elements equal to the 
+ * last one appended. Intervals must be appended
+ * in order.
+ *
+ * @tparam Expense whether to branch rather than 
+ * copy unconditionally
+ * @tparam E the element type
+ * @param i a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @param out the end of the unique prefix
+ * @param base the start of the unique prefix
+ */
+template<bool Expense, typename E, class Cmp>
+inline void emit
+    (
+    E * i,
+    E *const high,
+    const Cmp cmp,
+    E *& out,
+    E *const base
+    )
+{
+    if(out == base) 
+        *out++ = *i++;
+    for(; i <= high; ++i)
+    {
+        if constexpr (Expense)
+        {
+            if(cmp(out[-1], *i))
+                *out++ = *i;
+        }
+        else
+        {
+            const E e = *i;
+            *out = e;
+            out += cmp(out[-1], e);
+        }
+    }
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Unique Sort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts the given interval as qSort does, and 
+ * appends each finished part to the unique prefix 
+ * at out, so that duplicates are dropped as the 
+ * sort goes rather than in an extra pass. Parts 
+ * finish from left to right, and out never passes 
+ * the part being finished. So the pivot at low - 1 
+ * is intact whenever an interval reads it. When 
+ * pivot retention gathers the elements equal to 
+ * that pivot, they are discarded in place instead 
+ * of sorted, since the pivot was appended already.
+ * </p>
+ *
+ * @tparam Expense whether to use Hoare for fewer moves
+ * @tparam Block whether to use offset blocks
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @param height the distance of the current sort
+ * tree from the initial height of 2log<sub>2</sub>n
+ * @param leftmost whether this is the leftmost part
+ * @param out the end of the unique prefix
+ * @param base the start of the unique prefix
+ */
+template<bool Expense, bool Block, typename E, class Cmp>
+inline void uSort
+    (
+    E * low,
+    E *const high,
+    int height,
+    const Cmp cmp,
+    bool leftmost,
+    E *& out,
+    E *const base
+    )
+{
+    // Tail call loop.
+    for(;;)
+    {
+        const size_t x = high - low;
+
+        // Sort small intervals
+        // by insertion sort.
+        if(x < InsertionThreshold)
+        {
+            iSort<0,0,0>(low, high, cmp, leftmost);
+            return emit<Expense>(low, high, cmp, out, base);
+        }
+
+        // Heap sort when the runtime
+        // trends towards quadratic.
+        if(height < 0)
+        {
+            hSort(low, high, cmp);
+            return emit<Expense>(low, high, cmp, out, base);
+        }
+
+        // Select the pivot.
+        E * sl, * sr; bool runs;
+        E *const mid = choose<0,!Expense>
+            (low, high, cmp, sl, sr, runs, nullptr);
+
+        // If any middle candidate is
+        // equal to the pivot at left,
+        // gather its duplicates and
+        // discard them.
+        if(!leftmost)
+        {
+            E h = *(low - 1);
+            if(!cmp(h, *sl)  || 
+               !cmp(h, *mid) || 
+               !cmp(h, *sr))
+            {
+                low = partitionLeft
+                <Expense>(low, high, cmp);
+                if(low >= high)
+                {
+                    if(low == high)
+                        emit<Expense>
+                        (low, high, cmp, out, base);
+                    return;
+                }
+                continue;
+            }
+        }
+
+        // Partition the interval
+        // and skip the pivot.
+        bool work;
+        E *l = partition<Expense,Block>
+            (low, high, mid, cmp, work, runs);
+        E *const g = l + (l < high);
+        l -= (l > low);
+
+        const size_t 
+            _8th = x >> 3U,
+            ls = l - low,
+            gs = high - g;
+
+        // If the partition is fairly 
+        // balanced, try insertion sort.
+        if(ls >= _8th && 
+           gs >= _8th)
+        {
+            if(!work && iSort<0,0>
+               (low, l, cmp, leftmost))
+            {
+                emit<Expense>(low, l + (g - l == 2), 
+                    cmp, out, base);
+                if(iSort<1,0>(g, high, cmp))
+                    return emit<Expense>
+                    (g, high, cmp, out, base);
+                low = g;
+                leftmost = false;
+                continue;
+            }
+        }
+
+        // Otherwise, break patterns
+        // and decrement the height.
+        else
+        {
+            scramble(low, l, ls);
+            scramble(g, high, gs);
+            --height;
+        }
+
+        // Sort the left part, then 
+        // append the pivot if it is 
+        // not part of either side.
+        uSort<Expense,Block>
+        (low, l, height, cmp, leftmost, out, base);
+        if(g - l == 2)
+            emit<Expense>(l + 1, l + 1, cmp, out, base);
+
+        low = g;
+        leftmost = false;
+    }
+}
+
+/**
+ * sort and remove duplicates
+ * 
+ * @tparam E the element type
+ * @tparam Cmp the comparator type
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ * @param cmp the comparator
+ * @return the number of unique elements, 
+ * sorted at the front of the array
+ */
+template <bool Block = true, typename E, class Cmp>
+inline uint32_t blipsortUnique
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Cmp cmp
+    ) 
+{
+    if(cnt == 0) return 0;
+    E * out = a;
+    uSort
+    <Expensive<E>::value, Block>
+        (a, a + (cnt - 1), log2(cnt), cmp, true, out, a);
+    return uint32_t(out - a);
+}
+
+/**
+ * Galloping search. Finds the first position in 
+ * [low, r) from which the predicate holds through
+ * r - 1, probing exponentially leftward from r and 
+ * then searching the last gap by bisection. Costs
+ * O(log d) comparisons, where d is the distance 
+ * of the answer from r.
+ *
+ * @tparam E the element type
+ * @tparam Pred the predicate type
+ * @param low a pointer to the leftmost index
+ * @param r a pointer one past the rightmost index
+ * @param pred a predicate that is false and then 
+ * true over the range
+ * @return a pointer to the first position of the
+ * true run
+ */
+template<typename E, class Pred>
+inline E* gallop
+    (
+    E *const low,
+    E * r,
+    const Pred pred
+    )
+{
+    E * l = low;
+    for(size_t step = 1; size_t(r - low) > step; step <<= 1U)
+    {
+        E *const t = r - step;
+        if(!pred(*t))
+        {
+            l = t + 1;
+            break;
+        }
+        r = t;
+    }
+    while(l < r)
+    {
+        E *const m = l + ((r - l) >> 1U);
+        if(pred(*m)) r = m;
+        else l = m + 1;
+    }
+    return l;
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Append Sort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts the unsorted tail of the given array and 
+ * merges it into the sorted prefix. Tail elements 
+ * not less than the last prefix element are already 
+ * in place, and prefix elements not greater than 
+ * the first tail element never move, so both are 
+ * trimmed by galloping search. The rest of the tail 
+ * is copied to a buffer and merged from the back. 
+ * When either side wins GallopThreshold times in a 
+ * row, its run is found by galloping and moved as 
+ * a block. Equal elements keep the prefix first.
+ * </p>
+ *
+ * <p>
+ * Costs O(k log k + n) for a tail of k elements, 
+ * with at most k elements of scratch. If the 
+ * scratch can not be allocated, sorts the whole 
+ * array instead.
+ * </p>
+ *
+ * @tparam Block whether to use offset blocks
+ * @tparam Arena the scratch arena policy
+ * @tparam E the element type
+ * @param a the array
+ * @param m the size of the sorted prefix
+ * @param n the size of the array
+ * @param cmp the comparator
+ */
+template 
+<bool Block = true, class Arena = HeapArena, typename E, class Cmp>
+inline void blipsortAppend
+    (
+    E* const a,
+    const uint32_t m,
+    const uint32_t n,
+    const Cmp cmp
+    )
+{
+    if(n <= m) return;
+    if(m == 0) return blipsort<Block>(a, n, cmp);
+
+    // Sort the tail.
+    E *const t = a + m;
+    blipsort<Block>(t, n - m, cmp);
+
+    // Trim the tail elements that
+    // are in place already.
+    E *const te = gallop(t, a + n,
+        [&](const E & e) { return !cmp(e, t[-1]); });
+    if(te == t) return;
+
+    // Trim the prefix elements
+    // that never move.
+    E *const ps = gallop(a, t,
+        [&](const E & e) { return cmp(*t, e); });
+
+    // Buffer the tail.
+    const size_t k = te - t;
+    Arena arena;
+    Scratch<E, Arena> b(arena, k);
+    if(!b) return blipsort<Block>(a, n, cmp);
+    for(size_t x = 0; x < k; ++x)
+        b[x] = t[x];
+
+    // Merge from the back.
+    E * out = te - 1, * i = t - 1, * j = b.get() + (k - 1);
+    E *const bl = b.get();
+    uint32_t wi = 0, wj = 0;
+    while(j >= bl && i >= ps)
+    {
+        if(cmp(*j, *i))
+        {
+            wj = 0;
+            if(++wi < GallopThreshold)
+            {
+                *out-- = *i--;
+                continue;
+            }
+
+            // Gallop over the prefix
+            // elements greater than *j.
+            E *const q = gallop(ps, i + 1,
+                [&](const E & e) { return cmp(*j, e); });
+            while(i >= q) *out-- = *i--;
+            wi = 0;
+        }
+        else
+        {
+            wi = 0;
+            if(++wj < GallopThreshold)
+            {
+                *out-- = *j--;
+                continue;
+            }
+
+            // Gallop over the tail
+            // elements not less than *i.
+            E *const q = gallop(bl, j + 1,
+                [&](const E & e) { return !cmp(e, *i); });
+            while(j >= q) *out-- = *j--;
+            wj = 0;
+        }
+    }
+    while(j >= bl) *out-- = *j--;
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Keyed Pointer Sort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts pointers by a key read through each one. 
+ * Where a comparator chases both pointers, every 
+ * comparison may miss the cache. Here each key is 
+ * read once, in order and a window ahead, into a 
+ * scratch array of (key, pointer) pairs. The pairs 
+ * are sorted by key and the pointers copied back, 
+ * so no comparison touches a pointee.
+ * </p>
+ *
+ * <p>
+ * If the arena runs out, the pointers are sorted 
+ * in pointer mode instead.
+ * </p>
+ *
+ * @tparam Block whether to use offset blocks
+ * @tparam Arena the scratch arena policy
+ * @tparam E the pointer type
+ * @tparam Key the key projection type
+ * @tparam Cmp the key comparator type
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ * @param key the key projection
+ * @param cmp the key comparator
+ */
+template 
+<bool Block = true, class Arena = HeapArena, 
+ typename E, class Key, class Cmp = std::less<>>
+inline void blipsortKeyed
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Key key,
+    const Cmp cmp = Cmp()
+    )
+{
+    using K = std::decay_t<
+        std::invoke_result_t<const Key&, const E&>>;
+    struct Cached 
+    { 
+        K key; 
+        E e; 
+    };
+    if(cnt < 2) return;
+
+    Arena arena;
+    Scratch<Cached, Arena> c(arena, cnt);
+    if(!c) return blipsort<Block, PointerMode>(a, cnt, 
+        [&](const E & x, const E & y)
+        { 
+            return cmp(std::invoke(key, x), 
+                       std::invoke(key, y)); 
+        });
+
+    // Read the keys in order, 
+    // a window ahead.
+    for(uint32_t i = 0; i < cnt; ++i)
+    {
+        if(i + PointeeWindow < cnt)
+            fetch<PointerMode>(a + (i + PointeeWindow), 1);
+        c[i] = { std::invoke(key, a[i]), a[i] };
+    }
+    blipsort<Block>(c.get(), cnt, 
+        [&cmp](const Cached & x, const Cached & y)
+        { return cmp(x.key, y.key); });
+    for(uint32_t i = 0; i < cnt; ++i)
+        a[i] = c[i].e;
+}
+
+/**
+ * Sorts the given interval by binary insertion, 
+ * for the fewest comparisons on small intervals.
+ *
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ */
+template<typename E, class Cmp>
+inline void bSort
+    (
+    E *const low,
+    E *const high,
+    const Cmp cmp
+    )
+{
+    for(E* i = low + 1; i <= high; ++i)
+    {
+        // Find the upper bound 
+        // of *i in [low, i).
+        const E e = *i;
+        E* l = low;
+        for(size_t c = i - low; c > 0;)
+        {
+            const size_t h = c >> 1U;
+            if(cmp(e, l[h])) c = h;
+            else { l += h + 1; c -= h + 1; }
+        }
+        for(E* j = i; j > l; --j)
+            *j = j[-1];
+        *l = e;
+    }
+}
+
+/**
+ * Sorts the given interval by merge sort on 
+ * binary-inserted runs. Skips merges of halves 
+ * already in order, at the cost of one 
+ * comparison.
+ *
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @param buf scratch space for half the interval
+ */
+template<typename E, class Cmp>
+inline void mSort
+    (
+    E *const low,
+    E *const high,
+    const Cmp cmp,
+    E *const buf
+    )
+{
+    const size_t n = (high - low) + 1;
+    if(n <= CompareRun)
+        return bSort(low, high, cmp);
+
+    E *const m = low + (n >> 1U);
+    mSort(low, m - 1, cmp, buf);
+    mSort(m, high, cmp, buf);
+    if(!cmp(*m, m[-1])) return;
+
+    // Move the left half out, and
+    // merge it back from the front.
+    E * i = buf, * j = m, * o = low;
+    E *const ie = buf + (m - low);
+    for(E* k = low; k < m; ++k) *i++ = *k;
+    for(i = buf; i < ie && j <= high;)
+        *o++ = cmp(*j, *i) ? *j++ : *i++;
+    while(i < ie) *o++ = *i++;
+}
+
+/**
+ * Sorts the given interval with few comparisons. 
+ * As qSort, but pivots are pseudo-medians of 9 
+ * or 81 elements, partitioning is by Hoare, and 
+ * intervals below MergeThreshold are finished by 
+ * merge sort. Without a buffer, intervals below 
+ * InsertionThreshold are finished by binary 
+ * insertion instead.
+ *
+ * @tparam Block whether to use offset blocks
+ * @tparam E the element type
+ * @param low a pointer to the leftmost index
+ * @param high a pointer to the rightmost index
+ * @param height the distance of the current sort
+ * tree from the initial height of 2log<sub>2</sub>n
+ * @param leftmost whether this is the leftmost part
+ * @param buf scratch space for MergeThreshold / 2 
+ * elements, or null
+ */
+template<bool Block, typename E, class Cmp>
+inline void cSort
+    (
+    E * low,
+    E *const high,
+    int height,
+    const Cmp cmp,
+    bool leftmost,
+    E *const buf
+    )
+{
+    for(;;)
+    {
+        const size_t x = high - low;
+        if(x < (buf ? MergeThreshold : InsertionThreshold))
+        {
+            if(buf) mSort(low, high, cmp, buf);
+            else bSort(low, high, cmp);
+            return;
+        }
+
+        // Heap sort when the runtime
+        // trends towards quadratic.
+        if(height < 0)
+            return hSort(low, high, cmp);
+
+        // Select the pivot from 9 or
+        // 81 evenly spread elements.
+        const uint32_t levels = 
+            x < NintherThreshold ? 2 : 4;
+        const size_t n = levels == 2 ? 9 : 81;
+        E *const mid = ninther
+            (low + (x % n) / 2, x / n, levels, cmp);
+
+        // Retain the pivot to the
+        // left, as in qSort.
+        if(!leftmost && !cmp(low[-1], *mid))
+        {
+            low = partitionLeft<true>(low, high, cmp);
+            if(low >= high) return;
+            continue;
+        }
+
+        bool work;
+        E *l = partition<true,Block>
+            (low, high, mid, cmp, work);
+        E *const g = l + (l < high);
+        l -= (l > low);
+
+        // This was a bad partition,
+        // so decrement the height.
+        const size_t _8th = x >> 3U;
+        if(size_t(l - low) < _8th || 
+           size_t(high - g) < _8th)
+            --height;
+
+        cSort<Block>(low, l, height, cmp, leftmost, buf);
+        low = g;
+        leftmost = false;
+    }
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Frugal Sort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts with as few comparator calls as it can, 
+ * for comparators that cost far more than moves 
+ * or branches, such as collation-aware string 
+ * compares or decoders of compressed records. 
+ * Pivots are pseudo-medians of 9 elements, or 81 
+ * (a ninther of ninthers) on large intervals, so 
+ * splits are close to even. Intervals below 
+ * MergeThreshold are finished by merge sort on 
+ * runs sorted by binary insertion, which needs 
+ * about n log<sub>2</sub>n - n comparisons.
+ * </p>
+ *
+ * <p>
+ * Extra memory is MergeThreshold / 2 elements, 
+ * taken from the arena. If the arena runs out, 
+ * leaves are sorted by binary insertion alone.
+ * </p>
+ *
+ * @tparam Block whether to use offset blocks
+ * @tparam Arena the scratch arena policy
+ * @tparam E the element type
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ * @param cmp the comparator
+ * @return the number of comparisons made, over 
+ * n log<sub>2</sub>n
+ */
+template 
+<bool Block = true, class Arena = HeapArena, typename E, class Cmp>
+inline double blipsortFrugal
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Cmp cmp
+    )
+{
+    if(cnt < 2) return 0;
+
+    // Count each comparison.
+    uint64_t c = 0;
+    const auto count = [&c, &cmp]
+        (
+        const E & x,
+        const E & y
+        )
+    {
+        ++c;
+        return bool(cmp(x, y));
+    };
+
+    const double lg = 
+        double(cnt) * std::log2(double(cnt));
+    E *const high = a + (cnt - 1);
+
+    // Stop at once on sorted input.
+    // If the first pair descends,
+    // check for a reversed array.
+    E * i = a;
+    while(i < high && !count(i[1], *i)) ++i;
+    if(i == high) return double(c) / lg;
+    if(i == a)
+    {
+        const uint32_t miss = 
+            reversed(a, high, count);
+        if(miss <= ReverseTolerance)
+        {
+            reverse(a, high);
+            if(miss == 0) return double(c) / lg;
+        }
+    }
+
+    Arena arena;
+    Scratch<E, Arena> buf(arena, (cnt < MergeThreshold ? 
+        cnt : uint32_t(MergeThreshold)) >> 1U);
+    cSort<Block>(a, high, log2(cnt), 
+        count, true, buf.get());
+    return double(c) / lg;
+}
+
+/**
+ * The widest unsigned integer: 128 bits where
+ * the compiler supports __int128.
+ */
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 WideKey;
+#else
+typedef uint64_t WideKey;
+#endif
+
+/**
+ * The unsigned radix key of the same width as
+ * the given integer type.
+ */
+template<typename V>
+using RadixKey = 
+    typename std::conditional<sizeof(V) == 1, uint8_t,
+    typename std::conditional<sizeof(V) == 2, uint16_t,
+    typename std::conditional<sizeof(V) == 4, uint32_t,
+    typename std::conditional<sizeof(V) == 8, uint64_t,
+        WideKey>::type>::type>::type>::type;
+
+/**
+ * Maps an integer to an unsigned key of the same
+ * width whose order is the integer order: flips
+ * the sign bit of signed integers. Signedness is
+ * tested directly, since std::is_signed is false
+ * for __int128 in strict modes.
+ *
+ * @tparam V the integer type
+ * @param v the integer
+ */
+template<typename V>
+constexpr RadixKey<V> radixKey
+    (
+    const V v
+    )
+{
+    using U = RadixKey<V>;
+    constexpr U Sign = U(U(1) << (sizeof(U) * 8 - 1));
+    if constexpr (V(-1) < V(0))
+        return U(U(v) ^ Sign);
+    else
+        return U(v);
+}
+
+/**
+ * The index of the most significant byte in
+ * which the given difference of keys is set,
+ * counted from the top. Zero if the keys differ
+ * in their leading byte.
+ *
+ * @tparam U the key type
+ * @param d the difference of keys
+ */
+template<typename U>
+constexpr uint32_t leadByte
+    (
+    const U d
+    )
+{
+    if constexpr (sizeof(U) > 8)
+    {
+        const uint64_t hi = uint64_t(d >> 64U);
+        return hi ? std::countl_zero(hi) >> 3U :
+            8 + (std::countl_zero(uint64_t(d)) >> 3U);
+    }
+    else
+        return std::countl_zero(d) >> 3U;
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>rSort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts the given interval by most significant 
+ * digit radix (American flag sort), one byte per 
+ * level. A first pass finds the bytes shared by 
+ * every key of the interval, and skips them, so 
+ * a common prefix (a timestamp epoch or a network 
+ * prefix) costs one pass instead of one level per 
+ * byte. The elements are then counted into 256 
+ * buckets and moved into place by following 
+ * cycles, and each bucket is sorted on the next 
+ * byte. Buckets under RadixThreshold are sorted 
+ * by blipsort on their keys.
+ * </p>
+ *
+ * @tparam Block whether to use offset blocks
+ * @tparam E the element type
+ * @tparam Key the key projection type
+ * @param low the start of the interval
+ * @param cnt the size of the interval
+ * @param byte the first byte not yet sorted
+ * @param key the key projection
+ */
+template<bool Block, typename E, class Key>
+inline void rSort
+    (
+    E* const low,
+    const uint32_t cnt,
+    uint32_t byte,
+    const Key & key
+    )
+{
+    using V = std::decay_t
+        <std::invoke_result_t<const Key&, const E&>>;
+    using U = RadixKey<V>;
+    constexpr uint32_t Bytes = sizeof(U);
+    const auto k = [&key]
+        (
+        const E & e
+        )
+    {
+        return radixKey(V(std::invoke(key, e)));
+    };
+
+    // Sort small buckets by
+    // comparison.
+    if(cnt < RadixThreshold)
+    {
+        if(cnt > 1)
+            blipsort<Block>(low, cnt, [&k]
+                (
+                const E & x,
+                const E & y
+                )
+            {
+                return k(x) < k(y);
+            });
+        return;
+    }
+
+    // Count the digits. If all
+    // share one, skip the bytes
+    // shared by every key.
+    uint32_t s = (Bytes - 1 - byte) << 3U;
+    uint32_t c[256] = { }, h[256];
+    for(uint32_t i = 0; i < cnt; ++i)
+        ++c[uint8_t(k(low[i]) >> s)];
+    if(c[uint8_t(k(*low) >> s)] == cnt)
+    {
+        const U f = k(*low);
+        U d = 0;
+        for(uint32_t i = 1; i < cnt; ++i)
+            d |= k(low[i]) ^ f;
+        if(d == 0) return;
+        c[uint8_t(f >> s)] = 0;
+        byte = leadByte(d);
+        s = (Bytes - 1 - byte) << 3U;
+        for(uint32_t i = 0; i < cnt; ++i)
+            ++c[uint8_t(k(low[i]) >> s)];
+    }
+    h[0] = 0;
+    for(uint32_t b = 1; b < 256; ++b)
+        h[b] = h[b - 1] + c[b - 1];
+
+    // Swap each unplaced element to
+    // the head of its bucket. The
+    // swaps of one pass are
+    // independent, so they overlap.
+    // Repeat on the buckets that
+    // are not yet full.
+    uint32_t t[256], r[256], n = 0;
+    for(uint32_t b = 0; b < 256; ++b)
+        if(c[b]) t[b] = h[b] + c[b], r[n++] = b;
+    while(n)
+    {
+        uint32_t m = 0;
+        for(uint32_t j = 0; j < n; ++j)
+        {
+            const uint32_t b = r[j];
+            E * i = low + h[b], *const e = low + t[b];
+            for(; e - i >= 4; i += 4)
+            {
+                const uint8_t x0 = uint8_t(k(i[0]) >> s),
+                    x1 = uint8_t(k(i[1]) >> s),
+                    x2 = uint8_t(k(i[2]) >> s),
+                    x3 = uint8_t(k(i[3]) >> s);
+                std::swap(i[0], low[h[x0]++]);
+                std::swap(i[1], low[h[x1]++]);
+                std::swap(i[2], low[h[x2]++]);
+                std::swap(i[3], low[h[x3]++]);
+            }
+            for(; i < e; ++i)
+                std::swap(*i, low[h[uint8_t(k(*i) >> s)]++]);
+            if(h[b] < t[b]) r[m++] = b;
+        }
+        n = m;
+    }
+
+    // Sort each bucket on
+    // the next byte.
+    if(++byte == Bytes) return;
+    for(uint32_t b = 0, i = 0; b < 256; i += c[b++])
+        if(c[b] > 1)
+            rSort<Block>(low + i, c[b], byte, key);
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Radix Sort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts the given array in ascending order of an 
+ * integer key, by most significant digit radix. 
+ * Suited to wide keys (UUIDs, IPv6 addresses or 
+ * timestamps packed with an id into an unsigned 
+ * __int128) where each comparison costs two words 
+ * and the keys share long prefixes. Signed keys 
+ * have their sign bits flipped. The recursion is 
+ * at most one level per byte of the key, and takes 
+ * 4KB of stack per level. Elements with equal keys 
+ * may be reordered.
+ * </p>
+ *
+ * @tparam Block whether to use offset blocks
+ * @tparam E the element type
+ * @tparam Key the key projection type
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ * @param key the key projection
+ */
+template<bool Block = true, typename E, class Key>
+inline void blipsortRadix
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Key & key
+    )
+{
+    using V = std::decay_t
+        <std::invoke_result_t<const Key&, const E&>>;
+    static_assert(!std::is_floating_point<V>::value &&
+        !std::is_same<V, bool>::value &&
+        (std::is_integral<V>::value || sizeof(V) == 16) &&
+        sizeof(RadixKey<V>) == sizeof(V),
+        "blipsortRadix requires an integer key");
+    if(cnt < 2) return;
+    rSort<Block>(a, cnt, 0, key);
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Copy Sort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * Sorts a copy of the given array into the given 
+ * buffer, fusing the copy with the first 
+ * partition. The pivot is a pseudo-median of 9, 
+ * or 27 on large arrays, read from the source 
+ * without moving it. Each element is then read 
+ * from the source once and written to the 
+ * destination once, without branching: smaller 
+ * elements fill the destination from the left, 
+ * and the rest fill it from the right. Both 
+ * parts are then blipsorted in place. This saves 
+ * one pass over memory against copying first.
+ * </p>
+ *
+ * <p>
+ * The destination must hold cnt elements, which 
+ * are assigned to, and must not overlap the 
+ * source. The part from the right is filled in 
+ * reverse order, so a sorted source gives a 
+ * reversed right part, which blipsort turns 
+ * around in one pass. Types that are not 
+ * trivially copyable, such as strings, are 
+ * copied in order and then sorted: scattering 
+ * them leaves the memory they own out of order, 
+ * and sorting strings that way took 20% longer.
+ * </p>
+ *
+ * @tparam Block whether to use offset blocks
+ * @tparam E the element type
+ * @tparam Cmp the comparator type
+ * @param src the array to be copied
+ * @param dst the array to receive the sorted copy
+ * @param cnt the size of the the arrays
+ * @param cmp the comparator
+ */
+template<bool Block = true, typename E, class Cmp>
+inline void blipsortCopy
+    (
+    const E* const src,
+    E* const dst,
+    const uint32_t cnt,
+    const Cmp cmp
+    )
+{
+    // Copy small arrays, and
+    // types that own memory,
+    // and sort in place.
+    if(cnt < MedianThreshold ||
+       !std::is_trivially_copyable<E>::value)
+    {
+        for(uint32_t i = 0; i < cnt; ++i)
+            dst[i] = src[i];
+        if(cnt > 1)
+            blipsort<Block>(dst, cnt, cmp);
+        return;
+    }
+
+    // Find the pivot in the
+    // source, leaving it as is.
+    const uint32_t v = 2U + (cnt >= NintherThreshold);
+    const size_t d = cnt / (v == 2 ? 9 : 27);
+    const E p = *ninther(src + (d >> 1U), d, v, cmp);
+
+    // Copy each element to the
+    // next free slot on its side.
+    // Both slots are free until
+    // the last element, so write
+    // both, and advance one. If
+    // copies are expensive, 
+    // branch instead.
+    E * l = dst, * g = dst + (cnt - 1);
+    for(const E* i = src, *const e = src + cnt; i < e; ++i)
+    {
+        const bool s = cmp(*i, p);
+        if constexpr (Expensive<E>::value)
+        {
+            if(s) *l++ = *i;
+            else  *g-- = *i;
+        }
+        else
+        {
+            *l = *i; *g = *i;
+            l += s; g -= !s;
+        }
+    }
+
+    // Sort both parts in place.
+    const uint32_t ls = uint32_t(l - dst);
+    if(ls > 1)
+        blipsort<Block>(dst, ls, cmp);
+    if(cnt - ls > 1)
+        blipsort<Block>(l, cnt - ls, cmp);
+}
+
+/**
+ * Parses a Linux cpu or node list, such as
+ * "0-3,8-11", into its numbers.
+ *
+ * @param s the list
+ * @return the numbers
+ */
+inline std::vector<uint32_t> parseList
+    (
+    const std::string & s
+    )
+{
+    std::vector<uint32_t> v;
+    size_t i = 0;
+    while(i < s.size())
+    {
+        if(s[i] < '0' || s[i] > '9') 
+        { ++i; continue; }
+        uint32_t x = 0, y;
+        for(; i < s.size() && s[i] >= '0' && 
+              s[i] <= '9'; ++i)
+            x = x * 10 + (s[i] - '0');
+        y = x;
+        if(i < s.size() && s[i] == '-')
+            for(y = 0, ++i; i < s.size() && 
+                s[i] >= '0' && s[i] <= '9'; ++i)
+                y = y * 10 + (s[i] - '0');
+        for(; x <= y; ++x) v.push_back(x);
+    }
+    return v;
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Topology</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * The NUMA nodes of the machine and the CPUs of 
+ * each, in node order. Worker thread t of a 
+ * NUMA-aware sort is pinned to the t-th CPU, so 
+ * the threads of one node are numbered together.
+ * </p>
+ *
+ * <p>
+ * A topology may be detected from sysfs, or 
+ * emulated with any number of nodes. An emulated 
+ * topology maps its CPUs onto the real ones and 
+ * treats the array as split evenly among its 
+ * nodes, so the node-local paths can be exercised 
+ * on a machine with one node.
+ * </p>
+ */
+struct Topology
+{
+    // CPUs, in node order.
+    std::vector<uint32_t> cpu;
+    // First CPU of each node.
+    std::vector<uint32_t> first;
+    // Kernel id of each node.
+    std::vector<int> id;
+    // Whether to fault scratch
+    // pages in on their node.
+    bool touch = true;
+    bool emulated = false;
+
+    uint32_t nodes() const 
+    { 
+        return uint32_t(id.size()); 
+    }
+
+    uint32_t cpus() const 
+    { 
+        return uint32_t(cpu.size()); 
+    }
+
+    /**
+     * @param t a worker thread
+     * @return the node of the thread
+     */
+    uint32_t nodeOf
+        (
+        const uint32_t t
+        ) const
+    {
+        const uint32_t c = t % cpus();
+        uint32_t k = 0;
+        while(k + 1 < nodes() && first[k + 1] <= c) ++k;
+        return k;
+    }
+
+    /**
+     * @param kid a kernel node id
+     * @return the node with that id,
+     * or nodes() if nonesuch
+     */
+    uint32_t find
+        (
+        const int kid
+        ) const
+    {
+        uint32_t k = 0;
+        while(k < nodes() && id[k] != kid) ++k;
+        return k;
+    }
+
+    /**
+     * Reads the topology from sysfs, keeping
+     * only the CPUs this process may run on.
+     * Falls back to a single node.
+     *
+     * @return the topology
+     */
+    static Topology detect()
+    {
+        Topology t;
+#if defined(__linux__)
+        cpu_set_t own;
+        CPU_ZERO(&own);
+        const bool masked = 
+            sched_getaffinity(0, sizeof own, &own) == 0;
+        const std::string root = 
+            "/sys/devices/system/node/";
+        std::ifstream on(root + "online");
+        std::string s;
+        if(on && std::getline(on, s))
+        for(const uint32_t k : parseList(s))
+        {
+            std::ifstream cl(root + "node" + 
+                std::to_string(k) + "/cpulist");
+            std::string c;
+            if(!cl || !std::getline(cl, c)) 
+                continue;
+            const uint32_t f = t.cpus();
+            for(const uint32_t x : parseList(c))
+                if(!masked || (x < CPU_SETSIZE && 
+                    CPU_ISSET(x, &own)))
+                    t.cpu.push_back(x);
+            if(t.cpus() == f) continue;
+            t.first.push_back(f);
+            t.id.push_back(int(k));
+        }
+        if(t.cpus() > 0) return t;
+#endif
+        uint32_t h = std::thread::hardware_concurrency();
+        t.first.assign(1, 0);
+        t.id.assign(1, 0);
+        for(uint32_t x = 0; x < (h ? h : 1); ++x)
+            t.cpu.push_back(x);
+        return t;
+    }
+
+    /**
+     * @return the detected topology,
+     * read once
+     */
+    static const Topology & system()
+    {
+        static const Topology t = detect();
+        return t;
+    }
+
+    /**
+     * Emulates a topology of n nodes with c
+     * CPUs each. The CPUs wrap around onto
+     * the hardware threads.
+     *
+     * @param n the number of nodes
+     * @param c the CPUs per node
+     * @return the topology
+     */
+    static Topology emulate
+        (
+        const uint32_t n,
+        const uint32_t c
+        )
+    {
+        Topology t;
+        t.emulated = true;
+        uint32_t h = std::thread::hardware_concurrency();
+        if(h == 0) h = 1;
+        for(uint32_t k = 0; k < n; ++k)
+        {
+            t.first.push_back(k * c);
+            t.id.push_back(-1);
+            for(uint32_t x = 0; x < c; ++x)
+                t.cpu.push_back((k * c + x) % h);
+        }
+        return t;
+    }
+
+    /**
+     * Pins the calling thread to the CPU
+     * of worker t. Failure is harmless.
+     *
+     * @param t a worker thread
+     */
+    void pin
+        (
+        const uint32_t t
+        ) const
+    {
+#if defined(__linux__)
+        const uint32_t x = cpu[t % cpus()];
+        if(x >= CPU_SETSIZE) return;
+        cpu_set_t s;
+        CPU_ZERO(&s);
+        CPU_SET(x, &s);
+        pthread_setaffinity_np(
+            pthread_self(), sizeof s, &s);
+#endif
+    }
+
+    /**
+     * Finds the node holding each of the
+     * given addresses of an array. Falls 
+     * back to an even split of the array
+     * among the nodes where the kernel
+     * can not tell.
+     *
+     * @param base the array
+     * @param n the size of the array
+     * @param at the offsets to look up
+     * @param out the nodes
+     * @param m the number of offsets
+     */
+    template<typename E>
+    void locate
+        (
+        const E* const base,
+        const size_t n,
+        const size_t* const at,
+        uint32_t* const out,
+        const size_t m
+        ) const
+    {
+        std::vector<int> st(m, -1);
+#if defined(__linux__) && defined(SYS_move_pages)
+        if(!emulated && nodes() > 1)
+        {
+            const uintptr_t pg = 
+                uintptr_t(sysconf(_SC_PAGESIZE));
+            std::vector<void*> v(m);
+            for(size_t i = 0; i < m; ++i)
+                v[i] = (void*)(uintptr_t(
+                    base + at[i]) & ~(pg - 1));
+            if(syscall(SYS_move_pages, 0, m, 
+                v.data(), nullptr, st.data(), 0))
+                st.assign(m, -1);
+        }
+#endif
+        for(size_t i = 0; i < m; ++i)
+        {
+            uint32_t k = st[i] >= 0 ? 
+                find(st[i]) : nodes();
+            if(k == nodes())
+                k = uint32_t(at[i] * nodes() / n);
+            out[i] = k;
+        }
+    }
+};
+
+/**
+ * Runs f(t) for each t in [0, threads), each on 
+ * its own thread. The calling thread runs f(0).
+ * Given a topology, thread t is pinned to its
+ * t-th CPU, and the caller's affinity is put
+ * back afterward.
+ *
+ * @tparam F the function type
+ * @param threads the number of threads
+ * @param f the function
+ * @param topo the topology, or null
+ */
+template<class F>
+inline void parallel
+    (
+    const uint32_t threads,
+    const F & f,
+    const Topology* const topo = nullptr
+    )
+{
+    std::unique_ptr<std::thread[]> 
+        w(new std::thread[threads - 1]);
+    for(uint32_t t = 1; t < threads; ++t)
+        w[t - 1] = std::thread([&f, topo, t] 
+        { 
+            if(topo) topo->pin(t);
+            f(t); 
+        });
+#if defined(__linux__)
+    cpu_set_t own;
+    const bool saved = topo && 
+        pthread_getaffinity_np(pthread_self(), 
+            sizeof own, &own) == 0;
+    if(topo) topo->pin(0);
+    f(0);
+    if(saved) 
+        pthread_setaffinity_np(
+            pthread_self(), sizeof own, &own);
+#else
+    f(0);
+#endif
+    for(uint32_t t = 1; t < threads; ++t)
+        w[t - 1].join();
+}
+
+/**
+ * <h1>
+ *  <b>
+ *  <i>Sample Sort</i>
+ *  </b>
+ * </h1>
+ *
+ * <p>
+ * A parallel, in-place sample sort for very large 
+ * arrays, after IPS<sup>4</sup>o. Where recursive 
+ * parallel quicksort spends its first levels on 
+ * memory-bound partitions with little parallelism, 
+ * sample sort distributes the whole array into many 
+ * buckets in one parallel pass and then blipsorts 
+ * each bucket on its own thread.
+ * </p>
+ *
+ * <h2>Sampling</h2>
+ * <p>
+ * An oversampled set of Oversampling * 2<sup>L</sup> 
+ * elements is drawn from pseudo-random positions, 
+ * moved to the front and sorted by blipsort. Every 
+ * Oversampling-th sample becomes one of the 
+ * 2<sup>L</sup> - 1 splitters, which are laid out 
+ * as an implicit binary search tree.
+ * </p>
+ *
+ * <h2>Classification</h2>
+ * <p>
+ * Each thread walks its stripe of the array and 
+ * finds the bucket of each element by descending 
+ * the tree without branches, as in IPS<sup>4</sup>o. 
+ * Elements equal to a splitter go to an equality 
+ * bucket of their own, which needs no sorting, so 
+ * heavy duplicates can not unbalance the buckets. 
+ * Elements are gathered in per-bucket buffers of one 
+ * block. Full buffers are flushed back to the front 
+ * of the thread's own stripe, which has always been 
+ * read past by then.
+ * </p>
+ *
+ * <h2>Block Permutation</h2>
+ * <p>
+ * Each bucket's full blocks go to the front of a 
+ * block-aligned region that starts in the bucket. 
+ * The threads first gather the full blocks of each 
+ * region at its front, then swap the blocks home 
+ * in parallel, as in IPS<sup>4</sup>o. Each bucket 
+ * has one atomic word holding a write pointer and 
+ * a read pointer. A thread takes a block from the 
+ * read pointer of a bucket, and writes it at the 
+ * write pointer of its own bucket, carrying away 
+ * the block found there, if any, in a second swap 
+ * buffer. A block is only written over once the 
+ * threads reading from its bucket are done. The 
+ * last block of a bucket may overhang into the 
+ * head of the next bucket, or past the end of the 
+ * array, in which case it is kept in an overflow 
+ * block.
+ * </p>
+ *
+ * <h2>Cleanup</h2>
+ * <p>
+ * Each thread takes a range of buckets and, in 
+ * bucket order, writes each bucket's overhanging 
+ * elements and partial buffers to the gaps before 
+ * and after its region. Within a range, the next 
+ * bucket's head is only written after the overhang 
+ * is read. The overhangs that reach into the next 
+ * range, under one block, are saved beforehand, so 
+ * no element is lost.
+ * </p>
+ *
+ * <h2>NUMA</h2>
+ * <p>
+ * Given a topology, each worker is pinned to a CPU, 
+ * with the workers of one node numbered together. 
+ * The stripes follow the workers, so each node 
+ * classifies one contiguous share of the array, 
+ * and its buffers are faulted in on that node. 
+ * The block regions are listed by the node that 
+ * holds them. A node's workers gather and read 
+ * blocks from their own regions before helping 
+ * with the others, and each worker cleans up the 
+ * buckets that start in its own stripe. Each 
+ * bucket is then queued on the node that holds 
+ * its memory, and a node's workers drain their 
+ * own queue before stealing from the others.
+ * </p>
+ *
+ * <p>
+ * Extra memory is one block per bucket per thread, 
+ * plus two swap blocks per thread and one byte per 
+ * block of the array, taken from the arena. With a 
+ * topology, the buffers are instead allocated by 
+ * their own threads, so their pages land on their 
+ * nodes. If the arena runs out, the array is 
+ * blipsorted on the calling thread.
+ * </p>
+ *
+ * @authors Michael Axtmann - source
+ * @authors Sascha Witt - source
+ * @authors Daniel Ferizovic - source
+ * @authors Peter Sanders - source
+ * @authors Ellie Moore
+ * @tparam Block whether to use offset blocks
+ * @tparam Arena the scratch arena policy
+ * @tparam Mode the sort mode flags of the sample
+ * and bucket sorts
+ * @tparam E the element type
+ * @param a the array to be sorted
+ * @param cnt the size of the the array
+ * @param cmp the comparator
+ * @param threads the number of threads, or zero 
+ * for one per hardware thread, or per CPU of the 
+ * topology
+ * @param topo the topology, or null to ignore NUMA
+ */
+template 
+<bool Block = true, class Arena = HeapArena, uint32_t Mode = 0, 
+ typename E, class Cmp>
+inline void blipsortSample
+    (
+    E* const a,
+    const uint32_t cnt,
+    const Cmp cmp,
+    uint32_t threads = 0,
+    const Topology* const topo = nullptr
+    )
+{
+    if(threads == 0)
+        threads = topo ? topo->cpus() : 
+            std::thread::hardware_concurrency();
+    if(cnt < SampleThreshold || threads < 2)
+        return blipsort<Block, Mode>(a, cnt, cmp);
+
+    constexpr size_t 
+        L = TreeLevels,
+        M = (1U << L) - 1,
+        K = (M << 1U) + 1,
+        B = BucketBlockBytes / sizeof(E) > 0 ? 
+            BucketBlockBytes / sizeof(E) : 1;
+    constexpr uint8_t Empty = 0xFF;
+    static_assert(K <= Empty, "too many buckets");
+
+    const size_t n = cnt;
+    Arena arena;
+
+    // Draw the sample to the front
+    // and sort it.
+    constexpr size_t S = Oversampling * (M + 1);
+    uint64_t seed = n;
+    for(size_t i = 0; i < S; ++i)
+        swap(a + i, a + (i + pick(seed, n - i)));
+    blipsort<Block, Mode>(a, S, cmp);
+
+    // Pick the splitters, and lay
+    // them out as a search tree.
+    Scratch<E, Arena> sp(arena, M), tree(arena, M + 1);
+    if(!sp || !tree) return blipsort<Block, Mode>(a, cnt, cmp);
+    for(size_t i = 0; i < M; ++i)
+        sp[i] = a[(i + 1) * Oversampling - 1];
+    for(size_t i = 1; i <= M; ++i)
+    {
+        // Node r of level k holds the
+        // middle splitter of the r-th
+        // of the 2^k spans.
+        const size_t k = log2(uint32_t(i)), 
+            r = i - (size_t(1) << k);
+        tree[i] = sp[(((r << 1U) + 1) << (L - k - 1)) - 1];
+    }
+
+    // Finds the bucket of e: 2j for 
+    // elements between splitters j-1 
+    // and j, 2j+1 for those equal to 
+    // splitter j.
+    const auto classify = [&](const E & e)
+    {
+        size_t b = 1;
+        for(size_t l = 0; l < L; ++l)
+            b = (b << 1U) + cmp(tree[b], e);
+        const size_t j = b - (M + 1);
+        return uint8_t((j << 1U) + 
+            (j < M && !cmp(e, sp[j])));
+    };
+
+    // Split the array into block-
+    // aligned stripes.
+    const size_t 
+        nb = (n + (B - 1)) / B,
+        sb = (nb + (threads - 1)) / threads;
+    threads = uint32_t((nb + (sb - 1)) / sb);
+
+    Scratch<uint8_t, Arena> tag(arena, nb);
+    Scratch<size_t, Arena> 
+        fill(arena, threads * K),
+        full(arena, threads * K);
+    Scratch<E, Arena> ovf(arena, B);
+    // With a topology, each thread
+    // allocates its own buffers.
+    std::optional<Scratch<E, Arena>> pool;
+    if(!topo) pool.emplace(arena, threads * (K + 2) * B);
+    Scratch<E*, Arena> buf(arena, threads);
+    Scratch<std::atomic<uint64_t>, Arena> wr(arena, K);
+    Scratch<std::atomic<uint32_t>, Arena> rd(arena, K, true);
+    const uint32_t N = topo ? topo->nodes() : 1;
+    Scratch<size_t, Arena> rs(arena, N + 1, true);
+    Scratch<std::atomic<size_t>, Arena> rn(arena, N);
+    if(!tag || !fill || !full || !ovf || (pool && !*pool) || 
+       !buf || !wr || !rd || !rs || !rn)
+        return blipsort<Block, Mode>(a, cnt, cmp);
+    std::unique_ptr<std::unique_ptr<E[]>[]>
+        own(topo ? new std::unique_ptr<E[]>[threads] : nullptr);
+
+    // Classify each stripe into its
+    // thread's buffers, flushing full
+    // blocks to the stripe's front.
+    parallel(threads, [&](const uint32_t t)
+    {
+        // Allocated here, so the pages
+        // land on this thread's node. Two
+        // more blocks follow the buffers,
+        // for swapping.
+        E *const bf = buf[t] = !topo ? 
+            pool->get() + t * (K + 2) * B : 
+            (own[t] = std::unique_ptr<E[]>(topo->touch ? 
+                new E[(K + 2) * B]() : 
+                new E[(K + 2) * B])).get();
+        size_t *const f = fill.get() + t * K,
+              *const u = full.get() + t * K;
+        for(size_t b = 0; b < K; ++b)
+            f[b] = u[b] = 0;
+
+        const size_t 
+            lo = t * sb * B,
+            hi = (lo + sb * B) < n ? lo + sb * B : n;
+        Span stripe(Trace::ClassifyEvent, lo, hi - 1);
+        for(size_t q = lo / B; q * B < hi; ++q)
+            tag[q] = Empty;
+
+        size_t w = lo;
+        for(size_t r = lo; r < hi; ++r)
+        {
+            const uint8_t b = classify(a[r]);
+            bf[b * B + f[b]] = a[r];
+            if(++f[b] == B)
+            {
+                E *const o = a + w;
+                for(size_t i = 0; i < B; ++i)
+                    o[i] = bf[b * B + i];
+                tag[w / B] = b;
+                w += B;
+                f[b] = 0;
+                ++u[b];
+            }
+        }
+    }, topo);
+
+    // Find the bucket boundaries. The
+    // blocks of bucket b go to the 
+    // front of its region, the blocks
+    // [d[b], d[b + 1]).
+    Span perm(Trace::PermuteEvent, 0, n - 1);
+    size_t D[K + 1], d[K + 1], F[K];
+    D[0] = 0;
+    for(size_t b = 0; b < K; ++b)
+    {
+        size_t c = 0, fb = 0;
+        for(uint32_t t = 0; t < threads; ++t)
+        {
+            c  += full[t * K + b] * B + fill[t * K + b];
+            fb += full[t * K + b];
+        }
+        D[b + 1] = D[b] + c;
+        F[b] = fb * B;
+        d[b] = (D[b] + (B - 1)) / B * B;
+    }
+    d[K] = nb * B;
+
+    // The last block may hang 
+    // past the end of the array.
+    const size_t ql = n % B ? n / B : nb;
+    const auto slot = [&](const size_t q) 
+    {
+        return q == ql ? ovf.get() : a + q * B;
+    };
+
+    // List the regions by the node 
+    // holding their middle.
+    size_t ro[K], rm[K];
+    uint32_t rh[K];
+    for(size_t b = 0; b < K; ++b)
+        rm[b] = d[b] + d[b + 1] < n << 1U ? 
+            (d[b] + d[b + 1]) >> 1U : n - 1;
+    if(N > 1) topo->locate(a, n, rm, rh, K);
+    else for(size_t b = 0; b < K; ++b) rh[b] = 0;
+    for(size_t b = 0; b < K; ++b) ++rs[rh[b] + 1];
+    for(uint32_t k = 0; k < N; ++k) rs[k + 1] += rs[k];
+    for(uint32_t k = 0; k < N; ++k) rn[k] = rs[k];
+    for(size_t b = 0; b < K; ++b) ro[rn[rh[b]]++] = b;
+    for(uint32_t k = 0; k < N; ++k) rn[k] = rs[k];
+
+    // Gather the full blocks of each
+    // region at its front, on its own
+    // node first. Stripes are full 
+    // blocks then empty ones, so few 
+    // blocks move.
+    parallel(threads, [&](const uint32_t t)
+    {
+        const uint32_t h = topo ? topo->nodeOf(t) : 0;
+        for(uint32_t r = 0; r < N; ++r)
+        for(size_t x, k = (h + r) % N; 
+            (x = rn[k].fetch_add(1)) < rs[k + 1];)
+        {
+            const size_t b = ro[x];
+            size_t i = d[b] / B, j = d[b + 1] / B;
+            for(;;)
+            {
+                while(i < j && tag[i] != Empty) ++i;
+                while(i < j && tag[j - 1] == Empty) --j;
+                if(i >= j) break;
+                E *const s0 = a + --j * B, *const s1 = a + i * B;
+                for(size_t k = 0; k < B; ++k) s1[k] = s0[k];
+                tag[i++] = tag[j];
+                tag[j] = Empty;
+            }
+            wr[b] = uint64_t(d[b] / B) << 32U | i;
+        }
+    }, topo);
+
+    // Swap each full block into its
+    // region, in parallel, as in 
+    // IPS4o. wr[b] packs the write
+    // pointer of bucket b over its
+    // read pointer: the blocks before
+    // the write pointer are home, and
+    // those from the read pointer on
+    // are free. rd[b] counts threads
+    // still reading from bucket b. 
+    // Threads read from the regions
+    // of their own node first.
+    parallel(threads, [&](const uint32_t t)
+    {
+        E * x0 = buf[t] + K * B, * x1 = x0 + B;
+        const uint32_t h = topo ? topo->nodeOf(t) : 0;
+        for(uint32_t r = 0; r < N; ++r)
+        for(size_t k = (h + r) % N, 
+            m = rs[k + 1] - rs[k], j = 0; j < m; ++j)
+        {
+            const size_t c = ro[rs[k] + (t + j) % m];
+            for(;;)
+            {
+                // Take the last block
+                // yet to be moved.
+                ++rd[c];
+                uint64_t v = wr[c].load();
+                while(uint32_t(v) > (v >> 32U) &&
+                     !wr[c].compare_exchange_weak(v, v - 1));
+                if(uint32_t(v) <= (v >> 32U))
+                {
+                    --rd[c];
+                    break;
+                }
+                const size_t q = uint32_t(v) - 1;
+                uint8_t b = tag[q];
+                const E *const s0 = a + q * B;
+                for(size_t i = 0; i < B; ++i) x0[i] = s0[i];
+                --rd[c];
+
+                // Carry it home, swapping 
+                // out the blocks in its way.
+                for(;;)
+                {
+                    const uint64_t u = 
+                        wr[b].fetch_add(uint64_t(1) << 32U);
+                    const size_t z = u >> 32U;
+                    E *const s1 = slot(z);
+                    if(z >= uint32_t(u))
+                    {
+                        while(rd[b] != 0) 
+                            std::this_thread::yield();
+                        for(size_t i = 0; i < B; ++i) s1[i] = x0[i];
+                        tag[z] = b;
+                        break;
+                    }
+                    const uint8_t y = tag[z];
+                    if(y == b) continue;
+                    for(size_t i = 0; i < B; ++i) 
+                        x1[i] = s1[i], s1[i] = x0[i];
+                    tag[z] = b;
+                    E *const x = x0; x0 = x1; x1 = x;
+                    b = y;
+                }
+            }
+        }
+    }, topo);
+
+    // Bring the in-array part of
+    // the overflow block home.
+    if(ql < nb && tag[ql] != Empty)
+        for(size_t i = ql * B; i < n; ++i)
+            a[i] = ovf[i - ql * B];
+
+    // Each thread takes the range of
+    // buckets [b0, b1) that start in 
+    // its stripe, in its node's memory.
+    // Overhangs in [D[b1], d[b1]) lie
+    // in the head of a later range, so
+    // save them first.
+    const auto first = [&](const uint32_t t)
+    {
+        if(t == threads) return K;
+        size_t b = 0;
+        while(b < K && D[b] < t * sb * B) ++b;
+        return b;
+    };
+    for(uint32_t t = 0; t < threads; ++t)
+    {
+        const size_t b1 = first(t + 1);
+        if(first(t) == b1) continue;
+        E *const sv = buf[t] + K * B;
+        for(size_t i = D[b1]; i < d[b1]; ++i)
+            sv[i - D[b1]] = i < n ? a[i] : ovf[i - ql * B];
+    }
+
+    // Write each bucket's overhang and
+    // partial buffers into its gaps, in
+    // bucket order within each range.
+    parallel(threads, [&](const uint32_t t)
+    {
+        const size_t b0 = first(t), b1 = first(t + 1);
+        const E *const sv = buf[t] + K * B;
+        for(size_t b = b0; b < b1; ++b)
+        {
+            const size_t 
+                lo = D[b], hi = D[b + 1],
+                bs = F[b] ? d[b] : hi,
+                be = F[b] ? d[b] + F[b] : hi;
+            size_t w = lo;
+            const auto put = [&](const E & e)
+            {
+                if(w == bs) w = be;
+                a[w++] = e;
+            };
+            for(size_t i = hi; i < be; ++i)
+                put(i >= D[b1] ? sv[i - D[b1]] : 
+                    i < n ? a[i] : ovf[i - ql * B]);
+            for(uint32_t r = 0; r < threads; ++r)
+            {
+                const E *const bf = buf[r] + b * B;
+                for(size_t i = 0; i < fill[r * K + b]; ++i)
+                    put(bf[i]);
+            }
+        }
+    }, topo);
+    own.reset();
+    perm.end();
+
+    // Sort the buckets, largest
+    // first. Equality buckets are 
+    // sorted already.
+    size_t order[(K >> 1U) + 1], m = 0;
+    for(size_t b = 0; b < K; b += 2)
+        if(D[b + 1] - D[b] > 1) order[m++] = b;
+    for(size_t i = 1; i < m; ++i)
+    {
+        const size_t o = order[i];
+        size_t j = i;
+        for(; j > 0 && D[order[j - 1] + 1] - D[order[j - 1]] 
+              < D[o + 1] - D[o]; --j)
+            order[j] = order[j - 1];
+        order[j] = o;
+    }
+
+    // Queue each bucket on the node
+    // holding its middle, keeping
+    // the order within each queue.
+    size_t mid[(K >> 1U) + 1], q[(K >> 1U) + 1];
+    uint32_t home[(K >> 1U) + 1];
+    for(size_t i = 0; i < m; ++i)
+        mid[i] = (D[order[i]] + D[order[i] + 1]) >> 1U;
+    if(N > 1) topo->locate(a, n, mid, home, m);
+    else for(size_t i = 0; i < m; ++i) home[i] = 0;
+    Scratch<size_t, Arena> qs(arena, N + 1, true);
+    Scratch<std::atomic<size_t>, Arena> next(arena, N);
+    if(!qs || !next) return blipsort<Block, Mode>(a, cnt, cmp);
+    for(size_t i = 0; i < m; ++i) ++qs[home[i] + 1];
+    for(uint32_t k = 0; k < N; ++k) qs[k + 1] += qs[k];
+    for(uint32_t k = 0; k < N; ++k) next[k] = qs[k];
+    for(size_t i = 0; i < m; ++i)
+        q[next[home[i]]++] = order[i];
+    for(uint32_t k = 0; k < N; ++k) next[k] = qs[k];
+
+    // Drain the local queue, then
+    // steal from the others.
+    parallel(threads, [&](const uint32_t t)
+    {
+        const uint32_t h = topo ? topo->nodeOf(t) : 0;
+        for(uint32_t r = 0; r < N; ++r)
+        {
+            const uint32_t k = (h + r) % N;
+            for(size_t i; (i = next[k].fetch_add(1)) < qs[k + 1];)
+            {
+                const size_t b = q[i];
+                Span bucket(Trace::BucketEvent, 
+                    D[b], D[b + 1] - 1, 0, 
+                    Trace::scheme<Expensive<E>::value,
+                        Block,Mode>(false), 
+                    int64_t((b << 1U) | (r != 0)));
+                blipsort<Block, Mode>(a + D[b], 
+                    uint32_t(D[b + 1] - D[b]), cmp);
+            }
+        }
+    }, topo);
+}}
+
+namespace Arrays 
+{
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array with provided comparator
+     * or in ascending order if nonesuch.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     */
+    template <typename E, class Cmp = std::less<>>
+    constexpr void blipsort
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        Algo::blipsort(a, cnt, cmp);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_embed</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array with provided comparator
+     * or in ascending order if nonesuch. Conserves
+     * memory by using branchy Hoare instead of 
+     * Block Hoare on large types.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     */
+    template <typename E, class Cmp = std::less<>>
+    constexpr void blipsort_embed
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        Algo::blipsort<0>(a, cnt, cmp);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_random</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array with provided comparator
+     * or in ascending order if nonesuch. Draws pivot
+     * candidates and pattern-breaking swaps from a 
+     * generator seeded by the caller, so that crafted 
+     * (McIlroy "antiqsort") inputs can not force bad
+     * partitions without knowledge of the seed.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param seed the secret seed
+     * @param cmp the comparator
+     */
+    template <typename E, class Cmp = std::less<>>
+    inline void blipsort_random
+        (
+        E* const a,
+        const uint32_t cnt,
+        const uint64_t seed,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        Algo::blipsort<1, Algo::RandomMode>(a, cnt, cmp, seed);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_stream</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array with provided comparator
+     * or in ascending order if nonesuch. Meant for 
+     * arrays much larger than the last-level cache: 
+     * partitioning prefetches ahead of its scan 
+     * pointers, and intervals that fit in L2 are 
+     * finished in cache without prefetching.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     */
+    template <typename E, class Cmp = std::less<>>
+    inline void blipsort_stream
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        Algo::blipsort<1, Algo::StreamMode>(a, cnt, cmp);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_fiber</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array with provided comparator
+     * or in ascending order if nonesuch, without 
+     * recursion. Meant for fibers and coroutines 
+     * with small stacks: the larger part of each 
+     * partition waits on a fixed stack of at most 
+     * log<sub>2</sub>n intervals while the smaller 
+     * part is sorted.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     */
+    template <typename E, class Cmp = std::less<>>
+    inline void blipsort_fiber
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        Algo::blipsortFiber(a, cnt, cmp);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_buffered</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array with provided comparator
+     * or in ascending order if nonesuch. Small types 
+     * are partitioned by block-buffered Lomuto, 
+     * which records the offsets of small elements 
+     * and moves them in batches. It stores twice 
+     * per small element, where branchless Lomuto 
+     * stores twice per element, so about half as 
+     * much on an even split.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     */
+    template <typename E, class Cmp = std::less<>>
+    inline void blipsort_buffered
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        Algo::blipsort<1, Algo::BufferMode>(a, cnt, cmp);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_frugal</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array with provided comparator
+     * or in ascending order if nonesuch, making as 
+     * few comparator calls as it can. Meant for 
+     * comparators that cost far more than moves. 
+     * Returns the number of comparisons made, over
+     * n log<sub>2</sub>n.
+     * </p>
+     * 
+     * @tparam Arena the scratch arena policy
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     * @return the comparisons per n log<sub>2</sub>n
+     */
+    template 
+    <class Arena = Algo::HeapArena, typename E, class Cmp = std::less<>>
+    inline double blipsort_frugal
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        return Algo::blipsortFrugal<1, Arena>(a, cnt, cmp);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_radix</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array in ascending order of 
+     * an integer key, or of the elements themselves 
+     * if no key is given, by most significant digit 
+     * radix. Meant for wide keys, such as UUIDs and 
+     * IPv6 addresses in an unsigned __int128. 
+     * Elements with equal keys may be reordered.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Key the key projection type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param key the key projection
+     */
+    template <typename E, class Key = std::identity>
+    inline void blipsort_radix
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Key & key = Key()
+        ) 
+    {
+        Algo::blipsortRadix(a, cnt, key);
+    }
 
-        // Find the wwidth of the
-        // interval
-        x = high - low;
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_copy</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts a copy of the given array into the given
+     * buffer, with provided comparator or in 
+     * ascending order if nonesuch. The copy is fused 
+     * with the first partition, saving one pass over 
+     * memory. The buffer must hold cnt elements and 
+     * must not overlap the source.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param src the array to be copied
+     * @param dst the array to receive the sorted copy
+     * @param cnt the size of the the arrays
+     * @param cmp the comparator
+     */
+    template <typename E, class Cmp = std::less<>>
+    inline void blipsort_copy
+        (
+        const E* const src,
+        E* const dst,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        Algo::blipsortCopy(src, dst, cnt, cmp);
+    }
 
-        // If this is the root,
-        // sort the interval
-        // by insertion sort
-        // if small enough.
-        if constexpr (Root)
-        if (x < InsertionThreshold) 
-        {
-            // If we are in the Root,
-            // insertion sort will
-            // be unguarded.
-            iSort<1,0,0>(low, high, cmp);
-            return;
-        }
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_resumable</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Prepares a sort of the given array with provided 
+     * comparator, or in ascending order if nonesuch, 
+     * that runs in deadline-bounded steps. Call step 
+     * with a nanosecond budget until it returns true. 
+     * The prefix [0, sorted()) may be consumed early.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     * @return the resumable sort
+     */
+    template <typename E, class Cmp = std::less<>>
+    inline Algo::Resumable<E, Cmp> blipsort_resumable
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        return Algo::Resumable<E, Cmp>(a, cnt, cmp);
+    }
 
-        // If this is the root node, 
-        // heap sort when the runtime
-        // trends towards quadratic.
-        if constexpr (Root)
-        if(height < 0)
-            return hSort(low, high, cmp);
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_async</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array with provided comparator
+     * on the provided executor and returns at once. 
+     * Large intervals are partitioned into separate 
+     * tasks, so that several sorts may share one pool 
+     * of threads. The executor is any callable that 
+     * accepts a nullary callable and runs it later, 
+     * possibly on another thread. It must be safe to 
+     * call from its own tasks. If the comparator 
+     * throws, or the executor throws from a task, 
+     * the first exception is stored in the future. 
+     * If the executor throws on the first task, 
+     * blipsort_async throws it.
+     * </p>
+     * 
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @tparam Exec the executor type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     * @param exec the executor
+     * @return a future that becomes ready when the
+     * array is sorted
+     */
+    template <typename E, class Cmp, class Exec>
+    inline std::future<void> blipsort_async
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp,
+        const Exec exec
+        ) 
+    {
+        return Algo::blipsortAsync(a, cnt, cmp, exec);
+    }
 
-        leftmost = false;
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_float</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array of floats or doubles in 
+     * ascending order by sorting order-preserving 
+     * integer keys. NaNs are placed last, or first 
+     * with Algo::NaNsFirst. Algo::TotalOrder and 
+     * Algo::MergeZeros select IEEE totalOrder and 
+     * -0.0 to +0.0 rewriting, respectively.
+     * </p>
+     * 
+     * @tparam Policy the float policy flags
+     * @tparam F the floating point type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     */
+    template <uint32_t Policy = Algo::NaNsLast, typename F>
+    inline void blipsort_float
+        (
+        F* const a,
+        const uint32_t cnt
+        ) 
+    {
+        Algo::blipsortFloat<Policy>(a, cnt);
     }
-}
 
-/**
- * sort 
- * 
- * @tparam E the element type
- * @tparam Cmp the comparator type
- * @param a the array to be sorted
- * @param cnt the size of the the array
- * @param cmp the comparator
- */
-template <bool Block = true, typename E, class Cmp>
-inline void blipsort
-    (
-    E* const a,
-    const uint32_t cnt,
-    const Cmp cmp
-    ) 
-{
-    if(cnt < InsertionThreshold)
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_multi</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array lexicographically by the
+     * given keys, as in ORDER BY. A key is a callable 
+     * or member pointer that maps an element to an 
+     * ordered value. Wrap a key with descending to 
+     * reverse its order. Leading arithmetic keys are 
+     * packed into one integer key per element and 
+     * sorted by the integer path, and ties are refined 
+     * by the remaining keys.
+     * </p>
+     * 
+     * @tparam Arena the scratch arena policy
+     * @tparam E the element type
+     * @tparam Keys the key projection types
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param keys the key projections
+     */
+    template <class Arena = Algo::HeapArena, typename E, class... Keys>
+    inline void blipsort_multi
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Keys &... keys
+        ) 
     {
-        iSort<0,1,0>(a, a + (cnt - 1), cmp);
-        return;
+        Algo::blipsortMulti<Arena>(a, cnt, keys...);
     }
-    return qSort
-    <!std::is_arithmetic<E>::value && 
-     !std::is_pointer<E>::value, Block>
-        (a, a + (cnt - 1), log2(cnt), cmp);
-}}
 
-namespace Arrays 
-{
     /**
      * <h1>
      *  <b>
-     *  <i>blipsort</i>
+     *  <i>blipsort_unique</i>
      *  </b>
      * </h1> 
      * 
      * <p>
      * Sorts the given array with provided comparator
-     * or in ascending order if nonesuch.
+     * or in ascending order if nonesuch, and drops 
+     * duplicates during the sort. Returns the number 
+     * of unique elements, which are compacted at the 
+     * front of the array. The contents of the rest 
+     * of the array are unspecified.
      * </p>
      * 
      * @tparam E the element type
@@ -1287,47 +6772,218 @@ namespace Arrays
      * @param a the array to be sorted
      * @param cnt the size of the the array
      * @param cmp the comparator
+     * @return the number of unique elements
      */
     template <typename E, class Cmp = std::less<>>
-    inline void blipsort
+    inline uint32_t blipsort_unique
         (
         E* const a,
         const uint32_t cnt,
         const Cmp cmp = std::less<>()
         ) 
     {
-        Algo::blipsort(a, cnt, cmp);
+        return Algo::blipsortUnique(a, cnt, cmp);
     }
 
     /**
      * <h1>
      *  <b>
-     *  <i>blipsort_embed</i>
+     *  <i>blipsort_append</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the elements in [sorted_cnt, total_cnt) 
+     * with provided comparator or in ascending order 
+     * if nonesuch, and merges them into the sorted 
+     * prefix [0, sorted_cnt). Costs O(k log k + n) 
+     * for k new elements, with at most k elements of 
+     * scratch.
+     * </p>
+     * 
+     * @tparam Arena the scratch arena policy
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array
+     * @param sorted_cnt the size of the sorted prefix
+     * @param total_cnt the size of the array
+     * @param cmp the comparator
+     */
+    template 
+    <class Arena = Algo::HeapArena, typename E, class Cmp = std::less<>>
+    inline void blipsort_append
+        (
+        E* const a,
+        const uint32_t sorted_cnt,
+        const uint32_t total_cnt,
+        const Cmp cmp = std::less<>()
+        ) 
+    {
+        Algo::blipsortAppend<1, Arena>(a, sorted_cnt, total_cnt, cmp);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_parallel</i>
      *  </b>
      * </h1> 
      * 
      * <p>
      * Sorts the given array with provided comparator
-     * or in ascending order if nonesuch. Conserves
-     * memory by using branchy Hoare instead of 
-     * Block Hoare on large types.
+     * or in ascending order if nonesuch, on the given 
+     * number of threads (one per hardware thread if 
+     * zero). Arrays of SampleThreshold elements or 
+     * more are distributed into buckets by a parallel 
+     * in-place sample sort, and the buckets are 
+     * blipsorted in parallel. The comparator must not 
+     * throw.
      * </p>
      * 
+     * @tparam Arena the scratch arena policy
      * @tparam E the element type
      * @tparam Cmp the comparator type
      * @param a the array to be sorted
      * @param cnt the size of the the array
      * @param cmp the comparator
+     * @param threads the number of threads
      */
-    template <typename E, class Cmp = std::less<>>
-    inline void blipsort_embed
+    template 
+    <class Arena = Algo::HeapArena, typename E, class Cmp = std::less<>>
+    inline void blipsort_parallel
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>(),
+        const uint32_t threads = 0
+        ) 
+    {
+        Algo::blipsortSample<1, Arena>(a, cnt, cmp, threads);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_numa</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts the given array as blipsort_parallel does, 
+     * with one thread pinned to each CPU of the given 
+     * topology. Each node classifies its share of the 
+     * array and sorts the buckets held in its memory 
+     * first. The topology defaults to the one read 
+     * from sysfs; Algo::Topology::emulate builds one 
+     * for testing on a single-node machine.
+     * </p>
+     * 
+     * @tparam Arena the scratch arena policy
+     * @tparam E the element type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     * @param topo the topology
+     */
+    template 
+    <class Arena = Algo::HeapArena, typename E, class Cmp = std::less<>>
+    inline void blipsort_numa
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp = std::less<>(),
+        const Algo::Topology & topo = 
+            Algo::Topology::system()
+        ) 
+    {
+        Algo::blipsortSample<1, Arena>(a, cnt, cmp, 0, &topo);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_pointers</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts an array of pointers with a comparator 
+     * that dereferences them. Partitioning fetches 
+     * the pointees a window ahead of its scan 
+     * pointers, and insertion sort fetches a whole 
+     * interval's pointees before it starts, so the 
+     * cache misses overlap.
+     * </p>
+     * 
+     * @tparam E the pointer type
+     * @tparam Cmp the comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param cmp the comparator
+     */
+    template <typename E, class Cmp>
+    inline void blipsort_pointers
+        (
+        E* const a,
+        const uint32_t cnt,
+        const Cmp cmp
+        ) 
+    {
+        Algo::blipsort<1, Algo::PointerMode>(a, cnt, cmp);
+    }
+
+    /**
+     * <h1>
+     *  <b>
+     *  <i>blipsort_keyed</i>
+     *  </b>
+     * </h1> 
+     * 
+     * <p>
+     * Sorts an array of pointers by a key read 
+     * through each one. The keys are read once, 
+     * in order, into a scratch array of (key, 
+     * pointer) pairs, which is sorted instead.
+     * </p>
+     * 
+     * @tparam Arena the scratch arena policy
+     * @tparam E the pointer type
+     * @tparam Key the key projection type
+     * @tparam Cmp the key comparator type
+     * @param a the array to be sorted
+     * @param cnt the size of the the array
+     * @param key the key projection
+     * @param cmp the key comparator
+     */
+    template 
+    <class Arena = Algo::HeapArena, typename E, 
+     class Key, class Cmp = std::less<>>
+    inline void blipsort_keyed
         (
         E* const a,
         const uint32_t cnt,
+        const Key key,
         const Cmp cmp = std::less<>()
         ) 
     {
-        Algo::blipsort<0>(a, cnt, cmp);
+        Algo::blipsortKeyed<1, Arena>(a, cnt, key, cmp);
+    }
+
+    /**
+     * Marks a key of blipsort_multi for descending
+     * order.
+     *
+     * @tparam Key the key projection type
+     * @param key the key projection
+     */
+    template <class Key>
+    constexpr Algo::Descending<Key> descending
+        (
+        const Key key
+        )
+    {
+        return { key };
     }
 }
 
@@ -0,0 +1,160 @@
+#include "blipsort.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * A smoke test of the C ABI: each entry point
+ * sorts pseudo-random data, checked against
+ * qsort or against the order it promises.
+ */
+
+enum { Count = 1 << 20 };
+
+static uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+/**
+ * @return the next splitmix64 value
+ */
+static uint64_t next(void)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int cmpI32(const void* x, const void* y)
+{
+    const int32_t a = *(const int32_t*)x, b = *(const int32_t*)y;
+    return (a > b) - (a < b);
+}
+
+static int cmpU128(const void* x, const void* y)
+{
+    const blipsort_u128_t* a = x;
+    const blipsort_u128_t* b = y;
+    if(a->hi != b->hi) return (a->hi > b->hi) - (a->hi < b->hi);
+    return (a->lo > b->lo) - (a->lo < b->lo);
+}
+
+static int fail(const char* what)
+{
+    fprintf(stderr, "capi: %s\n", what);
+    return 1;
+}
+
+static int testI32(void)
+{
+    int32_t* a = malloc(Count * sizeof *a);
+    int32_t* b = malloc(Count * sizeof *b);
+    int bad = 0;
+    if(!a || !b) return fail("out of memory");
+    for(uint32_t i = 0; i < Count; ++i)
+        a[i] = b[i] = (int32_t)next();
+    blipsort_i32(a, Count);
+    qsort(b, Count, sizeof *b, cmpI32);
+    if(memcmp(a, b, Count * sizeof *a))
+        bad = fail("blipsort_i32 differs from qsort");
+
+    // Empty and single arrays.
+    blipsort_i32(a, 0);
+    blipsort_i32(a, 1);
+    free(a); free(b);
+    return bad;
+}
+
+static int testU64(void)
+{
+    uint64_t* a = malloc(Count * sizeof *a);
+    int bad = 0;
+    if(!a) return fail("out of memory");
+    for(uint32_t i = 0; i < Count; ++i)
+        a[i] = next() % 1000;
+    blipsort_u64(a, Count);
+    for(uint32_t i = 1; i < Count && !bad; ++i)
+        if(a[i - 1] > a[i])
+            bad = fail("blipsort_u64 out of order");
+    free(a);
+    return bad;
+}
+
+static int testF64(void)
+{
+    double* a = malloc(Count * sizeof *a);
+    uint32_t nans = 0, seen = 0;
+    int bad = 0;
+    if(!a) return fail("out of memory");
+    for(uint32_t i = 0; i < Count; ++i)
+    {
+        a[i] = (double)(int64_t)next() * 1e-9;
+        if(i % 997 == 0) a[i] = NAN, ++nans;
+    }
+    a[1] = -0.0; a[2] = 0.0;
+    a[3] = INFINITY; a[4] = -INFINITY;
+    blipsort_f64(a, Count);
+    for(uint32_t i = 0; i < Count; ++i)
+        seen += isnan(a[i]) != 0;
+    if(seen != nans)
+        bad = fail("blipsort_f64 lost a NaN");
+    for(uint32_t i = Count - nans; i < Count && !bad; ++i)
+        if(!isnan(a[i]))
+            bad = fail("blipsort_f64 did not put NaNs last");
+    for(uint32_t i = 1; i < Count - nans && !bad; ++i)
+        if(a[i - 1] > a[i] || (a[i - 1] == 0.0 &&
+           a[i] == 0.0 && !signbit(a[i - 1]) && signbit(a[i])))
+            bad = fail("blipsort_f64 out of order");
+    if(!bad && (a[0] != -INFINITY || a[Count - nans - 1] != INFINITY))
+        bad = fail("blipsort_f64 misplaced an infinity");
+    free(a);
+    return bad;
+}
+
+static int testKv(void)
+{
+    blipsort_kv_u64_u64_t* a = malloc(Count * sizeof *a);
+    int bad = 0;
+    if(!a) return fail("out of memory");
+    for(uint32_t i = 0; i < Count; ++i)
+    {
+        a[i].key = next() % 5000;
+        a[i].value = a[i].key * 3 + 1;
+    }
+    blipsort_kv_u64_u64(a, Count);
+    for(uint32_t i = 0; i < Count && !bad; ++i)
+        if((i > 0 && a[i - 1].key > a[i].key) ||
+           a[i].value != a[i].key * 3 + 1)
+            bad = fail("blipsort_kv_u64_u64 out of order");
+    free(a);
+    return bad;
+}
+
+static int testU128(void)
+{
+    blipsort_u128_t* a = malloc(Count * sizeof *a);
+    blipsort_u128_t* b = malloc(Count * sizeof *b);
+    int bad = 0;
+    if(!a || !b) return fail("out of memory");
+    for(uint32_t i = 0; i < Count; ++i)
+    {
+        a[i].hi = next() % 64;
+        a[i].lo = next();
+        b[i] = a[i];
+    }
+    blipsort_u128(a, Count);
+    qsort(b, Count, sizeof *b, cmpU128);
+    if(memcmp(a, b, Count * sizeof *a))
+        bad = fail("blipsort_u128 differs from qsort");
+    free(a); free(b);
+    return bad;
+}
+
+int main(void)
+{
+    const int bad = testI32() + testU64() +
+        testF64() + testKv() + testU128();
+    if(!bad) printf("capi: ok\n");
+    return bad != 0;
+}
@@ -0,0 +1,651 @@
+#include "sort.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+/**
+ * Tests of the header: antiqsort against the
+ * deterministic and the random modes, each
+ * Arrays entry point checked against std::sort,
+ * and blipsort in constant expressions, checked
+ * by static_assert when this file compiles.
+ */
+
+namespace
+{
+    int failures = 0;
+
+    void check
+        (
+        const bool ok,
+        const std::string & what
+        )
+    {
+        if(ok) return;
+        ++failures;
+        std::fprintf(stderr, "FAIL: %s\n", what.c_str());
+    }
+
+    /**
+     * The shapes of input each entry point sees.
+     */
+    enum Shape : uint32_t
+    {
+        Random,
+        FewUnique,
+        Ascending,
+        Descending,
+        Sawtooth,
+        Equal,
+        Shapes
+    };
+
+    const char* const ShapeNames[Shapes] =
+    {
+        "random", "few unique", "ascending",
+        "descending", "sawtooth", "equal"
+    };
+
+    std::vector<uint64_t> make
+        (
+        const Shape shape,
+        const uint32_t n,
+        std::mt19937_64 & r
+        )
+    {
+        std::vector<uint64_t> v(n);
+        for(uint32_t i = 0; i < n; ++i)
+        switch(shape)
+        {
+            case Random:     v[i] = r(); break;
+            case FewUnique:  v[i] = r() % 16; break;
+            case Ascending:  v[i] = i; break;
+            case Descending: v[i] = n - i; break;
+            case Sawtooth:   v[i] = i % 1024; break;
+            default:         v[i] = 7; break;
+        }
+        return v;
+    }
+
+    std::vector<uint64_t> sorted
+        (
+        std::vector<uint64_t> v
+        )
+    {
+        std::sort(v.begin(), v.end());
+        return v;
+    }
+
+    /**
+     * Runs sort on every shape at a few sizes,
+     * and compares each result with std::sort.
+     */
+    template<class Sort>
+    void crossCheck
+        (
+        const char* const name,
+        const Sort sort,
+        const std::vector<uint32_t> & sizes =
+            { 0, 1, 2, 31, 1000, 100000 }
+        )
+    {
+        std::mt19937_64 r(42);
+        for(const uint32_t n : sizes)
+        for(uint32_t s = 0; s < Shapes; ++s)
+        {
+            std::vector<uint64_t> v = make(Shape(s), n, r);
+            const std::vector<uint64_t> w = sorted(v);
+            sort(v);
+            check(v == w, std::string(name) + " on " +
+                ShapeNames[s] + " n=" + std::to_string(n));
+        }
+    }
+
+    /**
+     * Counts the comparisons of a sort.
+     */
+    template<class Sort>
+    uint64_t comparisons
+        (
+        std::vector<uint32_t> v,
+        const Sort sort
+        )
+    {
+        uint64_t c = 0;
+        sort(v, [&c](const uint32_t x, const uint32_t y)
+        {
+            ++c;
+            return x < y;
+        });
+        check(std::is_sorted(v.begin(), v.end()),
+            "sort under comparison count");
+        return c;
+    }
+
+    /**
+     * McIlroy's adversary forces the deterministic
+     * mode into bad partitions, which the heap sort
+     * fallback bounds. The random mode, whose seed
+     * the adversary does not know, must stay near
+     * the comparison count of random input.
+     */
+    void testAntiqsort()
+    {
+        constexpr uint32_t N = 1U << 20U;
+        std::vector<uint32_t> adv(N), rnd(N);
+        Algo::antiqsort(adv.data(), N);
+        std::vector<uint32_t> p = adv;
+        std::sort(p.begin(), p.end());
+        bool perm = true;
+        for(uint32_t i = 0; i < N; ++i) perm &= p[i] == i;
+        check(perm, "antiqsort yields a permutation");
+
+        std::mt19937 r(3);
+        for(uint32_t & x : rnd) x = r();
+
+        const auto plain = [](auto & v, auto cmp)
+        { Arrays::blipsort(v.data(), uint32_t(v.size()), cmp); };
+        const auto random = [](auto & v, auto cmp)
+        { Arrays::blipsort_random(v.data(), uint32_t(v.size()), 7, cmp); };
+
+        const double
+            base = double(comparisons(rnd, plain)),
+            det = comparisons(adv, plain) / base,
+            rm = comparisons(adv, random) / base;
+
+        // An adversary that knows a seed
+        // still does not know another one.
+        std::vector<uint32_t> known(N);
+        Algo::antiqsort<1, Algo::RandomMode>(known.data(), N, 99);
+        const double other = comparisons(known, random) / base;
+
+        std::printf("antiqsort n=%u, comparisons over random "
+            "input: default %.2f, random mode %.2f, "
+            "random mode against another seed %.2f\n",
+            N, det, rm, other);
+        check(det < 3.0, "default mode stays n log n on antiqsort");
+        check(rm < 1.1, "random mode stays near random input");
+        check(other < 1.1, "random mode hides its seed");
+    }
+
+    /**
+     * Runs the sample sorts with the given arena
+     * on a fresh thread, whose arena starts out
+     * empty, and checks that each one classified
+     * in parallel rather than falling back.
+     */
+    template<class Arena, class Setup>
+    void arenaCheck
+        (
+        const std::string & name,
+        const Setup setup
+        )
+    {
+        const std::vector<uint32_t> large = { (1U << 20U) + 777 };
+        const auto traced = [&](const std::string & what,
+                                const auto sort)
+        {
+            Algo::Trace::clear();
+            Algo::Trace::start();
+            crossCheck(what.c_str(), sort, large);
+            Algo::Trace::stop();
+            check(Algo::Trace::json().find("\"classify\"") !=
+                std::string::npos, what + " runs in parallel");
+        };
+        std::thread([&]
+        {
+            setup();
+            traced("blipsort_parallel with " + name,
+                [](std::vector<uint64_t> & v)
+                {
+                    Arrays::blipsort_parallel<Arena>(v.data(),
+                        uint32_t(v.size()), std::less<>(), 4);
+                });
+            traced("blipsort_numa with " + name,
+                [](std::vector<uint64_t> & v)
+                {
+                    Arrays::blipsort_numa<Arena>(v.data(),
+                        uint32_t(v.size()), std::less<>(),
+                        Algo::Topology::emulate(2, 2));
+                });
+        }).join();
+    }
+
+    /**
+     * A fixed pool of threads that run tasks
+     * from one queue, for the async sort.
+     */
+    class Pool
+    {
+        std::mutex m;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> q;
+        std::vector<std::thread> t;
+        bool done = false;
+
+        void run()
+        {
+            for(;;)
+            {
+                std::function<void()> f;
+                {
+                    std::unique_lock<std::mutex> l(m);
+                    cv.wait(l, [this] { return done || !q.empty(); });
+                    if(q.empty()) return;
+                    f = std::move(q.front());
+                    q.pop_front();
+                }
+                f();
+            }
+        }
+
+    public:
+
+        explicit Pool
+            (
+            const uint32_t n
+            )
+        {
+            for(uint32_t i = 0; i < n; ++i)
+                t.emplace_back([this] { run(); });
+        }
+
+        ~Pool()
+        {
+            {
+                std::lock_guard<std::mutex> l(m);
+                done = true;
+            }
+            cv.notify_all();
+            for(std::thread & x : t) x.join();
+        }
+
+        void submit
+            (
+            std::function<void()> f
+            )
+        {
+            {
+                std::lock_guard<std::mutex> l(m);
+                q.push_back(std::move(f));
+            }
+            cv.notify_one();
+        }
+    };
+
+    /**
+     * Runs blipsort_async on a pool of four
+     * threads, with the given comparator and
+     * a limit on the tasks the pool accepts.
+     * Returns the name of the exception get()
+     * throws, or the empty string.
+     */
+    template<class Cmp>
+    std::string asyncError
+        (
+        const Cmp cmp,
+        const uint32_t accepts
+        )
+    {
+        struct Refused { };
+        std::mt19937_64 r(7);
+        std::vector<uint64_t> v(1U << 20U);
+        for(uint64_t & x : v) x = r();
+        std::atomic<uint32_t> calls{0};
+        Pool pool(4);
+        try
+        {
+            Arrays::blipsort_async(v.data(), uint32_t(v.size()), cmp,
+                [&pool, &calls, accepts](auto f)
+                {
+                    if(calls.fetch_add(1) >= accepts)
+                        throw Refused();
+                    pool.submit(std::move(f));
+                }).get();
+        }
+        catch(const Refused &) { return "executor"; }
+        catch(const std::future_error &) { return "future_error"; }
+        catch(const std::exception & e) { return e.what(); }
+        return "";
+    }
+
+    /**
+     * A record too wide for Lomuto.
+     */
+    struct Wide
+    {
+        uint64_t key, pad[2];
+
+        constexpr bool operator<(const Wide & o) const
+        {
+            return key < o.key;
+        }
+    };
+
+    static_assert(!Algo::Expensive<uint32_t>::value &&
+        Algo::Expensive<Wide>::value);
+
+    constexpr uint64_t keyOf(const uint32_t e) { return e; }
+    constexpr uint64_t keyOf(const Wide & e) { return e.key; }
+
+    /**
+     * Sorts a table at compile time, half distinct
+     * keys and half runs of a few, and checks that
+     * it is an ordered permutation.
+     */
+    template<typename E, bool Block, uint32_t Mode>
+    constexpr bool sortsAtCompileTime()
+    {
+        constexpr uint32_t N = 3000;
+        const auto draw = [](uint64_t & x, const uint32_t i)
+        {
+            x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+            return uint32_t((x >> 33U) % (i < N / 2 ? N : 16));
+        };
+
+        std::array<E, N> a { };
+        std::array<int32_t, N> c { };
+        uint64_t x = 1;
+        for(uint32_t i = 0; i < N; ++i)
+        {
+            const uint32_t k = draw(x, i);
+            a[i] = E { k };
+            ++c[k];
+        }
+        Algo::blipsort<Block, Mode>(a.data(), N, std::less<>(), 99);
+
+        for(uint32_t i = 0; i < N; ++i)
+        {
+            if(i > 0 && a[i] < a[i - 1]) return false;
+            --c[keyOf(a[i])];
+        }
+        for(uint32_t i = 0; i < N; ++i)
+            if(c[i] != 0) return false;
+        return true;
+    }
+
+    // blipsort in constant expressions, for
+    // cheap and expensive types, in each mode
+    // that changes the partition loop.
+    static_assert(sortsAtCompileTime<uint32_t, true, 0>());
+    static_assert(sortsAtCompileTime<uint32_t, false, 0>());
+    static_assert(sortsAtCompileTime<uint32_t, true, Algo::RandomMode>());
+    static_assert(sortsAtCompileTime<uint32_t, true, Algo::StreamMode>());
+    static_assert(sortsAtCompileTime<uint32_t, true, Algo::BufferMode>());
+    static_assert(sortsAtCompileTime<Wide, true, 0>());
+    static_assert(sortsAtCompileTime<Wide, false, 0>());
+    static_assert(sortsAtCompileTime<Wide, true, Algo::RandomMode>());
+    static_assert(sortsAtCompileTime<Wide, true, Algo::StreamMode>());
+    static_assert(sortsAtCompileTime<Wide, true, Algo::BufferMode>());
+
+    /**
+     * An arena that is always out of memory.
+     */
+    struct NullArena
+    {
+        void* allocate(const size_t) { return nullptr; }
+        void deallocate(void* const, const size_t) { }
+    };
+
+    /**
+     * A record for the multi-column sort.
+     */
+    struct Row
+    {
+        uint32_t group;
+        double score;
+        uint64_t id;
+    };
+}
+
+int main()
+{
+    testAntiqsort();
+
+    crossCheck("blipsort_random", [](std::vector<uint64_t> & v)
+    { Arrays::blipsort_random(v.data(), uint32_t(v.size()), 12345); });
+
+    crossCheck("blipsort_stream", [](std::vector<uint64_t> & v)
+    { Arrays::blipsort_stream(v.data(), uint32_t(v.size())); });
+
+    crossCheck("blipsort_fiber", [](std::vector<uint64_t> & v)
+    { Arrays::blipsort_fiber(v.data(), uint32_t(v.size())); });
+
+    crossCheck("blipsort_buffered", [](std::vector<uint64_t> & v)
+    { Arrays::blipsort_buffered(v.data(), uint32_t(v.size())); });
+
+    crossCheck("blipsort_frugal", [](std::vector<uint64_t> & v)
+    { Arrays::blipsort_frugal(v.data(), uint32_t(v.size())); });
+
+    crossCheck("blipsort_radix", [](std::vector<uint64_t> & v)
+    { Arrays::blipsort_radix(v.data(), uint32_t(v.size())); });
+
+    crossCheck("blipsort_copy", [](std::vector<uint64_t> & v)
+    {
+        const std::vector<uint64_t> src = v;
+        std::fill(v.begin(), v.end(), 0);
+        Arrays::blipsort_copy(src.data(), v.data(), uint32_t(v.size()));
+    });
+
+    crossCheck("blipsort_resumable", [](std::vector<uint64_t> & v)
+    {
+        auto s = Arrays::blipsort_resumable(v.data(), uint32_t(v.size()));
+        uint32_t prefix = 0;
+        while(!s.step(20000))
+        {
+            // The sorted prefix only grows.
+            check(s.sorted() >= prefix, "blipsort_resumable prefix");
+            prefix = s.sorted();
+        }
+    });
+
+    crossCheck("blipsort_async", [](std::vector<uint64_t> & v)
+    {
+        Arrays::blipsort_async(v.data(), uint32_t(v.size()),
+            std::less<>(), [](auto f) { f(); }).get();
+    });
+
+    crossCheck("blipsort_async on a pool", [](std::vector<uint64_t> & v)
+    {
+        Pool pool(4);
+        Arrays::blipsort_async(v.data(), uint32_t(v.size()),
+            std::less<>(), [&pool](auto f)
+            { pool.submit(std::move(f)); }).get();
+    }, { 1000, (1U << 20U) + 777 });
+
+    // A comparator that throws partway through,
+    // and an executor that refuses its second 
+    // task: get() rethrows either exception.
+    {
+        std::atomic<uint64_t> n{0};
+        check(asyncError([&n](const uint64_t x, const uint64_t y)
+            {
+                if(n.fetch_add(1, std::memory_order_relaxed) == 3000000)
+                    throw std::runtime_error("comparator");
+                return x < y;
+            }, ~0U) == "comparator",
+            "blipsort_async rethrows the comparator's exception");
+        check(asyncError(std::less<>(), 1) == "executor",
+            "blipsort_async rethrows the executor's exception");
+        check(asyncError(std::less<>(), ~0U).empty(),
+            "blipsort_async on a pool throws nothing");
+    }
+
+    crossCheck("blipsort_append", [](std::vector<uint64_t> & v)
+    {
+        const uint32_t k = uint32_t(v.size() * 3 / 4);
+        std::sort(v.begin(), v.begin() + k);
+        Arrays::blipsort_append(v.data(), k, uint32_t(v.size()));
+    });
+
+    crossCheck("blipsort_pointers", [](std::vector<uint64_t> & v)
+    {
+        std::vector<const uint64_t*> p(v.size());
+        for(size_t i = 0; i < v.size(); ++i) p[i] = &v[i];
+        Arrays::blipsort_pointers(p.data(), uint32_t(p.size()),
+            [](const uint64_t* x, const uint64_t* y)
+            { return *x < *y; });
+        std::vector<uint64_t> w(v.size());
+        for(size_t i = 0; i < v.size(); ++i) w[i] = *p[i];
+        v = w;
+    });
+
+    crossCheck("blipsort_keyed", [](std::vector<uint64_t> & v)
+    {
+        std::vector<uint64_t*> p(v.size());
+        for(size_t i = 0; i < v.size(); ++i) p[i] = &v[i];
+        Arrays::blipsort_keyed(p.data(), uint32_t(p.size()),
+            [](const uint64_t* x) { return *x; });
+        std::vector<uint64_t> w(v.size());
+        for(size_t i = 0; i < v.size(); ++i) w[i] = *p[i];
+        v = w;
+    });
+
+    crossCheck("blipsort_unique", [](std::vector<uint64_t> & v)
+    {
+        // The rest of the array is unspecified,
+        // so compare the unique prefix alone.
+        const std::vector<uint64_t> all = sorted(v);
+        std::vector<uint64_t> w = all;
+        w.erase(std::unique(w.begin(), w.end()), w.end());
+        const uint32_t u =
+            Arrays::blipsort_unique(v.data(), uint32_t(v.size()));
+        check(std::vector<uint64_t>(v.begin(), v.begin() + u) == w,
+            "blipsort_unique prefix");
+        v = all;
+    });
+
+    const std::vector<uint32_t> large = { 1000, (1U << 20U) + 777 };
+    crossCheck("blipsort_parallel", [](std::vector<uint64_t> & v)
+    {
+        Arrays::blipsort_parallel(v.data(), uint32_t(v.size()),
+            std::less<>(), 4);
+    }, large);
+
+    crossCheck("blipsort_numa", [](std::vector<uint64_t> & v)
+    {
+        Arrays::blipsort_numa(v.data(), uint32_t(v.size()),
+            std::less<>(), Algo::Topology::emulate(2, 2));
+    }, large);
+
+    // Each arena, including a thread arena
+    // grown to exactly its first request
+    // and a buffer arena never provided.
+    const auto none = [] { };
+    arenaCheck<Algo::HeapArena>("HeapArena", none);
+    arenaCheck<Algo::StackArena<>>("StackArena", none);
+    arenaCheck<Algo::ThreadArena<>>("ThreadArena", none);
+    arenaCheck<Algo::HugeArena>("HugeArena", none);
+    arenaCheck<Algo::BufferArena>("BufferArena", none);
+    std::vector<char> buffer(1U << 20U);
+    arenaCheck<Algo::BufferArena>("provided BufferArena",
+        [&buffer]
+        { Algo::BufferArena::provide(buffer.data(), buffer.size()); });
+
+    // Floats: NaNs at the end chosen
+    // by the policy, the rest ordered.
+    {
+        std::mt19937_64 r(5);
+        std::vector<double> v(100000);
+        for(size_t i = 0; i < v.size(); ++i)
+            v[i] = i % 101 == 0 ? std::nan("") :
+                double(int64_t(r())) * 1e-9;
+        std::vector<double> f = v, l = v, w;
+        for(const double x : v) if(!std::isnan(x)) w.push_back(x);
+        std::sort(w.begin(), w.end());
+        const size_t nans = v.size() - w.size();
+        Arrays::blipsort_float(l.data(), uint32_t(l.size()));
+        Arrays::blipsort_float<Algo::NaNsFirst>
+            (f.data(), uint32_t(f.size()));
+        check(std::equal(w.begin(), w.end(), l.begin()) &&
+            std::all_of(l.end() - nans, l.end(),
+                [](double x) { return std::isnan(x); }),
+            "blipsort_float, NaNs last");
+        check(std::equal(w.begin(), w.end(), f.begin() + nans) &&
+            std::all_of(f.begin(), f.begin() + nans,
+                [](double x) { return std::isnan(x); }),
+            "blipsort_float, NaNs first");
+    }
+
+    // Multi-column: group ascending, score
+    // descending, then id ascending.
+    {
+        std::mt19937_64 r(6);
+        std::vector<Row> v(100000);
+        for(size_t i = 0; i < v.size(); ++i)
+            v[i] = { uint32_t(r() % 50), double(r() % 100), i };
+        std::vector<Row> w = v;
+        std::sort(w.begin(), w.end(),
+            [](const Row & x, const Row & y)
+            {
+                return std::tuple(x.group, -x.score, x.id) <
+                    std::tuple(y.group, -y.score, y.id);
+            });
+        Arrays::blipsort_multi(v.data(), uint32_t(v.size()),
+            &Row::group, Arrays::descending(&Row::score), &Row::id);
+        bool same = true;
+        for(size_t i = 0; i < v.size(); ++i)
+            same &= v[i].id == w[i].id;
+        check(same, "blipsort_multi");
+    }
+
+    // Multi-column without scratch: the column
+    // at a time fallback orders NaNs and signed
+    // zeros as the packed path does.
+    {
+        const double nan = std::nan("");
+        const double k[] = { 0.0, -0.0, nan, 1.0, -0.0, 0.0, nan, -1.0 };
+        std::vector<Row> v;
+        for(uint64_t i = 0; i < 8; ++i) v.push_back({ 0, k[i], i });
+        const auto bits = [](const std::vector<Row> & w)
+        {
+            std::vector<std::pair<uint64_t, uint64_t>> b;
+            for(const Row & x : w)
+                b.emplace_back(std::bit_cast<uint64_t>(x.score), x.id);
+            return b;
+        };
+        for(const bool desc : { false, true })
+        {
+            std::vector<Row> p = v, q = v;
+            if(desc)
+            {
+                Arrays::blipsort_multi(p.data(), 8U,
+                    Arrays::descending(&Row::score), &Row::id);
+                Arrays::blipsort_multi<NullArena>(q.data(), 8U,
+                    Arrays::descending(&Row::score), &Row::id);
+            }
+            else
+            {
+                Arrays::blipsort_multi(p.data(), 8U, &Row::score, &Row::id);
+                Arrays::blipsort_multi<NullArena>(q.data(), 8U,
+                    &Row::score, &Row::id);
+            }
+            const std::vector<uint64_t> want = desc ?
+                std::vector<uint64_t>{ 2, 6, 3, 0, 5, 1, 4, 7 } :
+                std::vector<uint64_t>{ 7, 1, 4, 0, 5, 3, 2, 6 };
+            bool order = true;
+            for(size_t i = 0; i < 8; ++i) order &= p[i].id == want[i];
+            check(order, "blipsort_multi orders NaNs and signed zeros");
+            check(bits(p) == bits(q),
+                "blipsort_multi without scratch matches packed");
+        }
+    }
+
+    if(failures == 0) std::printf("sort_test: ok\n");
+    return failures != 0;
+}